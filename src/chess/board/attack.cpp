@@ -20,6 +20,9 @@
 #include <cassert>
 
 #include "attack.h"
+#include "moves.h"
+
+#include "../eval/parameters.h"
 
 #include "../../game/math/bitscan.h"
 #include "../../game/math/bitreset.h"
@@ -32,8 +35,6 @@ extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
 
 extern Bitboard InBetween[Square::SQUARE_COUNT][Square::SQUARE_COUNT];
 
-extern Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT];
-
 ChessAttackGenerator::ChessAttackGenerator()
 {
 
@@ -44,6 +45,20 @@ ChessAttackGenerator::~ChessAttackGenerator()
 
 }
 
+Bitboard ChessAttackGenerator::getAllAttackingPieces(ChessBoard& board, Square dst, Bitboard occupied)
+{
+    Bitboard bishops = board.whitePieces[PieceType::BISHOP] | board.blackPieces[PieceType::BISHOP] | board.whitePieces[PieceType::QUEEN] | board.blackPieces[PieceType::QUEEN];
+    Bitboard rooks = board.whitePieces[PieceType::ROOK] | board.blackPieces[PieceType::ROOK] | board.whitePieces[PieceType::QUEEN] | board.blackPieces[PieceType::QUEEN];
+
+    //Pawn captures are looked up from the opposite side's point of view
+    return (WhitePawnCaptures[dst] & board.blackPieces[PieceType::PAWN])
+        | (BlackPawnCaptures[dst] & board.whitePieces[PieceType::PAWN])
+        | (PieceMoves[PieceType::KNIGHT][dst] & (board.whitePieces[PieceType::KNIGHT] | board.blackPieces[PieceType::KNIGHT]))
+        | (PieceMoves[PieceType::KING][dst] & (board.whitePieces[PieceType::KING] | board.blackPieces[PieceType::KING]))
+        | (BishopAttacks(dst, occupied) & bishops)
+        | (RookAttacks(dst, occupied) & rooks);
+}
+
 Bitboard ChessAttackGenerator::getAttackingPieces(ChessBoard& board, Square dst, bool earlyExit, Bitboard attackThrough)
 {
     bool whiteToMove = board.sideToMove == Color::WHITE;
@@ -96,6 +111,72 @@ Bitboard ChessAttackGenerator::getAttackingPieces(ChessBoard& board, Square dst,
     return attackingPieces;
 }
 
+bool ChessAttackGenerator::givesCheck(ChessBoard& board, ChessMove& move)
+{
+    bool whiteToMove = board.sideToMove == Color::WHITE;
+
+    Square src = move.src;
+    Square dst = move.dst;
+
+    PieceType movingPiece = board.pieces[src];
+
+    Square otherKingPosition = whiteToMove ? board.blackKingPosition : board.whiteKingPosition;
+    Bitboard otherKing = OneShiftedBy(otherKingPosition);
+
+    Bitboard* piecesToMove = whiteToMove ? board.whitePieces : board.blackPieces;
+
+    //1) Direct check.  A promoting pawn checks as its new piece, looking through the square it left.
+    if (move.promotionPiece != PieceType::NO_PIECE) {
+        Bitboard occupied = board.allPieces ^ OneShiftedBy(src);
+
+        switch (move.promotionPiece) {
+        case PieceType::KNIGHT:
+            if ((PieceMoves[PieceType::KNIGHT][dst] & otherKing) != EmptyBitboard) { return true; }
+            break;
+        case PieceType::BISHOP:
+            if ((BishopAttacks(dst, occupied) & otherKing) != EmptyBitboard) { return true; }
+            break;
+        case PieceType::ROOK:
+            if ((RookAttacks(dst, occupied) & otherKing) != EmptyBitboard) { return true; }
+            break;
+        default:
+            if (((BishopAttacks(dst, occupied) | RookAttacks(dst, occupied)) & otherKing) != EmptyBitboard) { return true; }
+            break;
+        }
+    }
+    else if ((board.checkSquares[movingPiece] & OneShiftedBy(dst)) != EmptyBitboard) {
+        return true;
+    }
+
+    //2) Discovered check.  The piece must leave the line between our slider and the other king.
+    if ((board.discoveredCheckPieces & OneShiftedBy(src)) != EmptyBitboard
+        && (InBetween[otherKingPosition][src] & OneShiftedBy(dst)) == EmptyBitboard
+        && (InBetween[otherKingPosition][dst] & OneShiftedBy(src)) == EmptyBitboard) {
+        return true;
+    }
+
+    //3) En passant removes two pieces from a line at once
+    if (movingPiece == PieceType::PAWN
+        && dst == board.enPassant) {
+        Square capturedSquare = dst + (whiteToMove ? Direction::DOWN : Direction::UP);
+        Bitboard occupied = (board.allPieces ^ OneShiftedBy(src) ^ OneShiftedBy(capturedSquare)) | OneShiftedBy(dst);
+
+        return ((BishopAttacks(otherKingPosition, occupied) & (piecesToMove[PieceType::BISHOP] | piecesToMove[PieceType::QUEEN]))
+            | (RookAttacks(otherKingPosition, occupied) & (piecesToMove[PieceType::ROOK] | piecesToMove[PieceType::QUEEN]))) != EmptyBitboard;
+    }
+
+    //4) When castling, the rook lands on the square the king passed over
+    if (movingPiece == PieceType::KING
+        && (dst == src + Direction::RIGHT * 2 || dst == src + Direction::LEFT * 2)) {
+        Square rookSquare = Square((src + dst) / 2);
+        Bitboard occupied = (board.allPieces ^ OneShiftedBy(src)) | OneShiftedBy(dst);
+
+        return (RookAttacks(rookSquare, occupied) & otherKing) != EmptyBitboard;
+    }
+
+    return false;
+}
+
 bool ChessAttackGenerator::isInCheck(ChessBoard& board, bool otherSide)
 {
     bool whiteToMove = board.sideToMove == Color::WHITE;
@@ -160,3 +241,98 @@ bool ChessAttackGenerator::isSquareAttacked(ChessBoard& board, Square dst)
 
     return this->getAttackingPieces(board, dst, false, kingBitboard) != EmptyBitboard;
 }
+
+bool ChessAttackGenerator::seeGreaterOrEqual(ChessBoard& board, ChessMove& move, Score threshold)
+{
+    Square src = move.src;
+    Square dst = move.dst;
+
+    PieceType movingPiece = board.pieces[src];
+    PieceType capturedPiece = board.pieces[dst];
+
+    //The only capture onto an empty square is en passant
+    if (movingPiece == PieceType::PAWN
+        && dst == board.enPassant) {
+        capturedPiece = PieceType::PAWN;
+    }
+
+    //1) If winning the captured piece outright doesn't reach the threshold, nothing else will
+    Score swap = MaterialParameters[capturedPiece].mg - threshold;
+
+    if (swap < ZERO_SCORE) {
+        return false;
+    }
+
+    //2) If losing the moving piece in return still reaches the threshold, we're done
+    swap = MaterialParameters[movingPiece].mg - swap;
+
+    if (swap <= ZERO_SCORE) {
+        return true;
+    }
+
+    //3) Play out the exchange with the least valuable attacker on each side until one side can't recapture or gives up
+    Bitboard occupied = board.allPieces ^ OneShiftedBy(src) ^ OneShiftedBy(dst);
+    Bitboard attackers = this->getAllAttackingPieces(board, dst, occupied);
+
+    Bitboard bishops = board.whitePieces[PieceType::BISHOP] | board.blackPieces[PieceType::BISHOP] | board.whitePieces[PieceType::QUEEN] | board.blackPieces[PieceType::QUEEN];
+    Bitboard rooks = board.whitePieces[PieceType::ROOK] | board.blackPieces[PieceType::ROOK] | board.whitePieces[PieceType::QUEEN] | board.blackPieces[PieceType::QUEEN];
+
+    bool whiteToMove = board.sideToMove == Color::WHITE;
+    bool result = true;
+
+    while (true) {
+        whiteToMove = !whiteToMove;
+        attackers &= occupied;
+
+        Bitboard* piecesToMove = whiteToMove ? board.whitePieces : board.blackPieces;
+        Bitboard sideToMoveAttackers = attackers & piecesToMove[PieceType::ALL];
+
+        if (sideToMoveAttackers == EmptyBitboard) {
+            break;
+        }
+
+        result = !result;
+
+        //4) Find the least valuable attacker
+        PieceType attacker = PieceType::PAWN;
+
+        while ((sideToMoveAttackers & piecesToMove[attacker]) == EmptyBitboard) {
+            attacker++;
+        }
+
+        //5) The king may only recapture if the other side has nothing left to recapture with
+        if (attacker == PieceType::KING) {
+            Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
+
+            if ((attackers & otherPieces[PieceType::ALL]) != EmptyBitboard) {
+                result = !result;
+            }
+
+            break;
+        }
+
+        swap = MaterialParameters[attacker].mg - swap;
+
+        if (swap < Score(result)) {
+            break;
+        }
+
+        //6) Remove the attacker and add any sliders it was blocking
+        Bitboard attackingPieces = sideToMoveAttackers & piecesToMove[attacker];
+
+        occupied ^= attackingPieces & (0 - attackingPieces);
+
+        if (attacker == PieceType::PAWN
+            || attacker == PieceType::BISHOP
+            || attacker == PieceType::QUEEN) {
+            attackers |= BishopAttacks(dst, occupied) & bishops;
+        }
+
+        if (attacker == PieceType::ROOK
+            || attacker == PieceType::QUEEN) {
+            attackers |= RookAttacks(dst, occupied) & rooks;
+        }
+    }
+
+    return result;
+}
@@ -30,8 +30,12 @@ public:
 	ChessAttackGenerator();
 	~ChessAttackGenerator();
 
+	Bitboard getAllAttackingPieces(ChessBoard& board, Square dst, Bitboard occupied);
 	Bitboard getAttackingPieces(ChessBoard& board, Square dst, bool earlyExit, Bitboard attackThrough);
 
+	bool givesCheck(ChessBoard& board, ChessMove& move);
 	bool isInCheck(ChessBoard& board, bool otherSide = false);
 	bool isSquareAttacked(ChessBoard& board, Square dst);
+
+	bool seeGreaterOrEqual(ChessBoard& board, ChessMove& move, Score threshold);
 };
@@ -19,6 +19,7 @@
 #include <sstream>
 
 #include "board.h"
+#include "moves.h"
 
 #include "../../game/math/bitreset.h"
 #include "../../game/math/bitscan.h"
@@ -30,6 +31,8 @@
 
 #include "../types/square.h"
 
+#include "../eval/parameters.h"
+
 const std::string startingPositionFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
 static const std::string PieceToChar = " PNBRQK  pnbrqk";
@@ -41,9 +44,6 @@ extern Bitboard BlackPawnCaptures[Square::SQUARE_COUNT];
 extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
 extern Bitboard InBetween[Square::SQUARE_COUNT][Square::SQUARE_COUNT];
 
-extern Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT];
-extern Evaluation PstParameters[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
-
 extern Hash PieceHashValues[Color::COLOR_COUNT][PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
 extern Hash WhiteToMoveHash;
 extern Hash CastleRightsHashValues[CastleRights::CASTLERIGHTS_COUNT];
@@ -59,6 +59,7 @@ ChessBoard::~ChessBoard()
 
 }
 
+template<bool performPreCalculations>
 void ChessBoard::buildAttackBoards()
 {
     bool whiteToMove = this->sideToMove == Color::WHITE;
@@ -122,6 +123,39 @@ void ChessBoard::buildAttackBoards()
     this->checkingPieces = checkingPieces;
     this->pinnedPieces = pinnedPieces;
     this->inBetweenSquares = inBetweenSquares;
+
+    //Only the search asks whether a move gives check; perft's boards skip the rest
+    if (!performPreCalculations) {
+        return;
+    }
+
+    //4) Find the squares each of our pieces would give check from.  Pawn captures are looked up from the other side's point of view.
+    Square otherKingPosition = whiteToMove ? this->blackKingPosition : this->whiteKingPosition;
+    Bitboard* piecesToMove = whiteToMove ? this->whitePieces : this->blackPieces;
+
+    this->checkSquares[PieceType::PAWN] = whiteToMove ? BlackPawnCaptures[otherKingPosition] : WhitePawnCaptures[otherKingPosition];
+    this->checkSquares[PieceType::KNIGHT] = PieceMoves[PieceType::KNIGHT][otherKingPosition];
+    this->checkSquares[PieceType::BISHOP] = BishopAttacks(otherKingPosition, this->allPieces);
+    this->checkSquares[PieceType::ROOK] = RookAttacks(otherKingPosition, this->allPieces);
+    this->checkSquares[PieceType::QUEEN] = this->checkSquares[PieceType::BISHOP] | this->checkSquares[PieceType::ROOK];
+    this->checkSquares[PieceType::KING] = EmptyBitboard;
+
+    //5) Our pieces which are the only piece in between one of our sliders and the other king will discover check when they move
+    Bitboard discoveredCheckPieces = EmptyBitboard;
+    Bitboard sliders = (PieceMoves[PieceType::BISHOP][otherKingPosition] & (piecesToMove[PieceType::BISHOP] | piecesToMove[PieceType::QUEEN]))
+        | (PieceMoves[PieceType::ROOK][otherKingPosition] & (piecesToMove[PieceType::ROOK] | piecesToMove[PieceType::QUEEN]));
+
+    while (BitScanForward64((std::uint32_t *)&src, sliders)) {
+        sliders = ResetLowestSetBit(sliders);
+
+        inBetween = InBetween[otherKingPosition][src] & this->allPieces;
+
+        if (popCountIsOne(inBetween)) {
+            discoveredCheckPieces |= inBetween & piecesToMove[PieceType::ALL];
+        }
+    }
+
+    this->discoveredCheckPieces = discoveredCheckPieces;
 }
 
 void ChessBoard::buildBitboardsFromMailbox()
@@ -160,6 +194,21 @@ void ChessBoard::buildBitboardsFromMailbox()
     }
 }
 
+void ChessBoard::countPieces()
+{
+    this->pieceCount = 0;
+
+    for (Color color = Color::COLOR_START; color < Color::COLOR_COUNT; color++) {
+        Bitboard* pieces = color == Color::WHITE ? this->whitePieces : this->blackPieces;
+
+        for (PieceType piece = PieceType::PAWN; piece <= PieceType::ALL; piece++) {
+            this->pieceCounts[color][piece] = popCount(pieces[piece]);
+        }
+
+        this->pieceCount += this->pieceCounts[color][PieceType::ALL];
+    }
+}
+
 Hash ChessBoard::calculateHash()
 {
     Hash result = EmptyHash;
@@ -214,13 +263,12 @@ Hash ChessBoard::calculateMaterialHash()
     return result;
 }
 
-Evaluation ChessBoard::calculateMaterialEvaluation()
+ChessEvaluation ChessBoard::calculateMaterialEvaluation()
 {
-    Evaluation result = { NO_SCORE, NO_SCORE };
+    ChessEvaluation result = ZeroChessEvaluation;
 
     for (PieceType piece = PieceType::PAWN; piece < PieceType::KING; piece++) {
-        result += MaterialParameters[piece] * static_cast<std::int32_t>(popCountSparse(this->whitePieces[piece]));
-        result -= MaterialParameters[piece] * static_cast<std::int32_t>(popCountSparse(this->blackPieces[piece]));
+        result += MaterialValues[piece] * (static_cast<std::int32_t>(popCountSparse(this->whitePieces[piece])) - static_cast<std::int32_t>(popCountSparse(this->blackPieces[piece])));
     }
 
     return result;
@@ -247,9 +295,9 @@ Hash ChessBoard::calculatePawnHash()
     return result;
 }
 
-Evaluation ChessBoard::calculatePstEvaluation()
+ChessEvaluation ChessBoard::calculatePstEvaluation()
 {
-    Evaluation result = { NO_SCORE, NO_SCORE };
+    ChessEvaluation result = ZeroChessEvaluation;
 
     Bitboard srcSquares;
 
@@ -270,7 +318,7 @@ Evaluation ChessBoard::calculatePstEvaluation()
                     src = FlipSqY(src);
                 }
 
-                result += multiplier * PstParameters[piece][src];
+                result += multiplier * PstValues[piece][src];
             }
         }
     }
@@ -294,6 +342,14 @@ void ChessBoard::clearEverything()
 
     this->allPieces = EmptyBitboard;
 
+    for (Color color = Color::COLOR_START; color < Color::COLOR_COUNT; color++) {
+        for (piece = PieceType::NO_PIECE; piece <= PieceType::ALL; piece++) {
+            this->pieceCounts[color][piece] = 0;
+        }
+    }
+
+    this->pieceCount = 0;
+
     this->sideToMove = Color::WHITE;
     this->castleRights = CastleRights::CASTLE_ALL;
     this->enPassant = Square::NO_SQUARE;
@@ -312,8 +368,8 @@ void ChessBoard::clearEverything()
     this->materialHashValue = EmptyHash;
     this->pawnHashValue = EmptyHash;
 
-    this->materialEvaluation = { NO_SCORE, NO_SCORE };
-    this->pstEvaluation = { NO_SCORE, NO_SCORE };
+    this->materialEvaluation = ZeroChessEvaluation;
+    this->pstEvaluation = ZeroChessEvaluation;
 
     this->nullMove = false;
 }
@@ -359,12 +415,12 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
             this->pawnHashValue ^= PieceHashValues[otherColor][PieceType::PAWN][dst + dir];
 
             if (whiteToMove) {
-                this->pstEvaluation += multiplier * PstParameters[PieceType::PAWN][FlipSqY(dst + dir)];
-                this->pstEvaluation -= multiplier * PstParameters[PieceType::PAWN][FlipSqY(dst)];
+                this->pstEvaluation += multiplier * PstValues[PieceType::PAWN][FlipSqY(dst + dir)];
+                this->pstEvaluation -= multiplier * PstValues[PieceType::PAWN][FlipSqY(dst)];
             }
             else {
-                this->pstEvaluation += multiplier * PstParameters[PieceType::PAWN][dst + dir];
-                this->pstEvaluation -= multiplier * PstParameters[PieceType::PAWN][dst];
+                this->pstEvaluation += multiplier * PstValues[PieceType::PAWN][dst + dir];
+                this->pstEvaluation -= multiplier * PstValues[PieceType::PAWN][dst];
             }
         }
     }
@@ -378,12 +434,12 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
 
     if (performPreCalculations) {
         if (whiteToMove) {
-            this->pstEvaluation += multiplier * PstParameters[movingPiece][dst];
-            this->pstEvaluation -= multiplier * PstParameters[movingPiece][src];
+            this->pstEvaluation += multiplier * PstValues[movingPiece][dst];
+            this->pstEvaluation -= multiplier * PstValues[movingPiece][src];
         }
         else {
-            this->pstEvaluation += multiplier * PstParameters[movingPiece][FlipSqY(dst)];
-            this->pstEvaluation -= multiplier * PstParameters[movingPiece][FlipSqY(src)];
+            this->pstEvaluation += multiplier * PstValues[movingPiece][FlipSqY(dst)];
+            this->pstEvaluation -= multiplier * PstValues[movingPiece][FlipSqY(src)];
         }
 
         this->hashValue ^= PieceHashValues[colorToMove][movingPiece][src];
@@ -445,8 +501,8 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
                 this->pieces[Square::H1] = PieceType::NO_PIECE;
 
                 if (performPreCalculations) {
-                    this->pstEvaluation += multiplier * PstParameters[PieceType::ROOK][Square::F1];
-                    this->pstEvaluation -= multiplier * PstParameters[PieceType::ROOK][Square::H1];
+                    this->pstEvaluation += multiplier * PstValues[PieceType::ROOK][Square::F1];
+                    this->pstEvaluation -= multiplier * PstValues[PieceType::ROOK][Square::H1];
 
                     this->hashValue ^= PieceHashValues[Color::WHITE][PieceType::ROOK][Square::F1];
                     this->hashValue ^= PieceHashValues[Color::WHITE][PieceType::ROOK][Square::H1];
@@ -460,8 +516,8 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
                 this->pieces[Square::A1] = PieceType::NO_PIECE;
 
                 if (performPreCalculations) {
-                    this->pstEvaluation += multiplier * PstParameters[PieceType::ROOK][Square::D1];
-                    this->pstEvaluation -= multiplier * PstParameters[PieceType::ROOK][Square::A1];
+                    this->pstEvaluation += multiplier * PstValues[PieceType::ROOK][Square::D1];
+                    this->pstEvaluation -= multiplier * PstValues[PieceType::ROOK][Square::A1];
 
                     this->hashValue ^= PieceHashValues[Color::WHITE][PieceType::ROOK][Square::D1];
                     this->hashValue ^= PieceHashValues[Color::WHITE][PieceType::ROOK][Square::A1];
@@ -481,8 +537,8 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
                 this->pieces[Square::H8] = PieceType::NO_PIECE;
 
                 if (performPreCalculations) {
-                    this->pstEvaluation += multiplier * PstParameters[PieceType::ROOK][FlipSqY(Square::F8)];
-                    this->pstEvaluation -= multiplier * PstParameters[PieceType::ROOK][FlipSqY(Square::H8)];
+                    this->pstEvaluation += multiplier * PstValues[PieceType::ROOK][FlipSqY(Square::F8)];
+                    this->pstEvaluation -= multiplier * PstValues[PieceType::ROOK][FlipSqY(Square::H8)];
 
                     this->hashValue ^= PieceHashValues[Color::BLACK][PieceType::ROOK][Square::F8];
                     this->hashValue ^= PieceHashValues[Color::BLACK][PieceType::ROOK][Square::H8];
@@ -496,8 +552,8 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
                 this->pieces[Square::A8] = PieceType::NO_PIECE;
 
                 if (performPreCalculations) {
-                    this->pstEvaluation += multiplier * PstParameters[PieceType::ROOK][FlipSqY(Square::D8)];
-                    this->pstEvaluation -= multiplier * PstParameters[PieceType::ROOK][FlipSqY(Square::A8)];
+                    this->pstEvaluation += multiplier * PstValues[PieceType::ROOK][FlipSqY(Square::D8)];
+                    this->pstEvaluation -= multiplier * PstValues[PieceType::ROOK][FlipSqY(Square::A8)];
 
                     this->hashValue ^= PieceHashValues[Color::BLACK][PieceType::ROOK][Square::D8];
                     this->hashValue ^= PieceHashValues[Color::BLACK][PieceType::ROOK][Square::A8];
@@ -513,16 +569,16 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
     //6) Change the capturedpiece bitboard
     if (capturedPiece != PieceType::NO_PIECE) {
         if (performPreCalculations) {
-            this->materialEvaluation += multiplier * MaterialParameters[capturedPiece];
+            this->materialEvaluation += multiplier * MaterialValues[capturedPiece];
 
-            std::uint32_t pieceTypeCount = popCount(otherPieces[capturedPiece]);
+            std::int32_t pieceTypeCount = this->pieceCounts[otherColor][capturedPiece];
             this->materialHashValue ^= PieceHashValues[otherColor][capturedPiece][pieceTypeCount] ^ PieceHashValues[otherColor][capturedPiece][pieceTypeCount - 1];
 
             if (whiteToMove) {
-                this->pstEvaluation += multiplier * PstParameters[capturedPiece][FlipSqY(dst)];
+                this->pstEvaluation += multiplier * PstValues[capturedPiece][FlipSqY(dst)];
             }
             else {
-                this->pstEvaluation += multiplier * PstParameters[capturedPiece][dst];
+                this->pstEvaluation += multiplier * PstValues[capturedPiece][dst];
             }
 
             this->hashValue ^= PieceHashValues[otherColor][capturedPiece][dst];
@@ -531,6 +587,10 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
         otherPieces[capturedPiece] = otherPieces[capturedPiece] ^ OneShiftedBy(dst);
         otherPieces[PieceType::ALL] = otherPieces[PieceType::ALL] ^ OneShiftedBy(dst);
 
+        this->pieceCounts[otherColor][capturedPiece]--;
+        this->pieceCounts[otherColor][PieceType::ALL]--;
+        this->pieceCount--;
+
         switch (capturedPiece) {
         case PieceType::PAWN:
             if (performPreCalculations) {
@@ -564,22 +624,22 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
         this->pieces[dst] = promotionPiece;
 
         if (performPreCalculations) {
-            this->materialEvaluation += multiplier * MaterialParameters[promotionPiece];
-            this->materialEvaluation -= multiplier * MaterialParameters[PieceType::PAWN];
+            this->materialEvaluation += multiplier * MaterialValues[promotionPiece];
+            this->materialEvaluation -= multiplier * MaterialValues[PieceType::PAWN];
 
-            std::uint32_t pieceTypeCount = popCount(piecesToMove[promotionPiece]);
+            std::int32_t pieceTypeCount = this->pieceCounts[colorToMove][promotionPiece];
             this->materialHashValue ^= PieceHashValues[colorToMove][promotionPiece][pieceTypeCount] ^ PieceHashValues[colorToMove][promotionPiece][pieceTypeCount + 1];
 
-            pieceTypeCount = popCount(piecesToMove[PieceType::PAWN]);
+            pieceTypeCount = this->pieceCounts[colorToMove][PieceType::PAWN];
             this->materialHashValue ^= PieceHashValues[colorToMove][PieceType::PAWN][pieceTypeCount] ^ PieceHashValues[colorToMove][PieceType::PAWN][pieceTypeCount - 1];
 
             if (whiteToMove) {
-                this->pstEvaluation += multiplier * PstParameters[promotionPiece][dst];
-                this->pstEvaluation -= multiplier * PstParameters[PieceType::PAWN][dst];
+                this->pstEvaluation += multiplier * PstValues[promotionPiece][dst];
+                this->pstEvaluation -= multiplier * PstValues[PieceType::PAWN][dst];
             }
             else {
-                this->pstEvaluation += multiplier * PstParameters[promotionPiece][FlipSqY(dst)];
-                this->pstEvaluation -= multiplier * PstParameters[PieceType::PAWN][FlipSqY(dst)];
+                this->pstEvaluation += multiplier * PstValues[promotionPiece][FlipSqY(dst)];
+                this->pstEvaluation -= multiplier * PstValues[PieceType::PAWN][FlipSqY(dst)];
             }
 
             this->hashValue ^= PieceHashValues[colorToMove][PieceType::PAWN][dst];
@@ -590,6 +650,9 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
 
         piecesToMove[promotionPiece] = piecesToMove[promotionPiece] | OneShiftedBy(dst);
         piecesToMove[PieceType::PAWN] = piecesToMove[PieceType::PAWN] ^ OneShiftedBy(dst);
+
+        this->pieceCounts[colorToMove][promotionPiece]++;
+        this->pieceCounts[colorToMove][PieceType::PAWN]--;
     }
 
     //9) Switch side to move
@@ -625,7 +688,12 @@ void ChessBoard::doMoveImplementation(ChessMove& move)
     //10) Set all pieces bitboard
     this->allPieces = this->whitePieces[PieceType::ALL] | this->blackPieces[PieceType::ALL];
 
-    this->buildAttackBoards();
+    //12) Update the network's accumulators
+    if (performPreCalculations && NetworkEnabled) {
+        this->updateAccumulators(move, oldEnPassant);
+    }
+
+    this->buildAttackBoards<performPreCalculations>();
 }
 
 void ChessBoard::doNullMove()
@@ -721,6 +789,7 @@ void ChessBoard::initFromFen(const std::string& fen)
     ss >> std::skipws >> this->fiftyMoveCount >> this->fullMoveCount;
 
     this->buildBitboardsFromMailbox();
+    this->countPieces();
     this->buildAttackBoards();
 
     this->materialEvaluation = this->calculateMaterialEvaluation();
@@ -729,6 +798,88 @@ void ChessBoard::initFromFen(const std::string& fen)
     this->hashValue = this->calculateHash();
     this->materialHashValue = this->calculateMaterialHash();
     this->pawnHashValue = this->calculatePawnHash();
+
+    if (NetworkEnabled) {
+        this->refreshAccumulators();
+    }
+}
+
+void ChessBoard::refreshAccumulator(Color perspective)
+{
+    std::int16_t* values = this->accumulator.values[perspective];
+    Square kingSquare = perspective == Color::WHITE ? this->whiteKingPosition : this->blackKingPosition;
+
+    ResetNetworkAccumulator(values);
+
+    for (Color color = Color::COLOR_START; color < Color::COLOR_COUNT; color++) {
+        Bitboard* pieces = color == Color::WHITE ? this->whitePieces : this->blackPieces;
+
+        for (PieceType piece = PieceType::PAWN; piece < PieceType::KING; piece++) {
+            Bitboard srcSquares = pieces[piece];
+
+            Square src;
+            while (BitScanForward64((std::uint32_t *)&src, srcSquares)) {
+                srcSquares = ResetLowestSetBit(srcSquares);
+
+                AddNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, color, piece, src));
+            }
+        }
+    }
+}
+
+void ChessBoard::refreshAccumulators()
+{
+    this->refreshAccumulator(Color::WHITE);
+    this->refreshAccumulator(Color::BLACK);
+}
+
+//Called at the end of doMove, so the side to move has already been switched
+void ChessBoard::updateAccumulators(ChessMove& move, Square oldEnPassant)
+{
+    Color movedColor = ~this->sideToMove;
+    Color otherColor = this->sideToMove;
+
+    Square src = move.src;
+    Square dst = move.dst;
+
+    PieceType movingPiece = move.movedPiece;
+    PieceType capturedPiece = move.capturedPiece;
+    PieceType placedPiece = (movingPiece == PieceType::PAWN && move.promotionPiece != PieceType::NO_PIECE) ? move.promotionPiece : movingPiece;
+
+    //1) doMove shifts an en passant victim onto the destination square first, so it is really captured behind it
+    Square capturedSquare = dst;
+    if (movingPiece == PieceType::PAWN && dst == oldEnPassant) {
+        capturedSquare = dst + (movedColor == Color::WHITE ? Direction::DOWN : Direction::UP);
+    }
+
+    //2) A castle also moves the rook
+    bool isCastle = movingPiece == PieceType::KING && (dst == src + Direction::RIGHT * 2 || dst == src + Direction::LEFT * 2);
+    Square rookSrc = dst > src ? dst + Direction::RIGHT : dst + Direction::LEFT * 2;
+    Square rookDst = dst > src ? dst + Direction::LEFT : dst + Direction::RIGHT;
+
+    for (Color perspective = Color::COLOR_START; perspective < Color::COLOR_COUNT; perspective++) {
+        std::int16_t* values = this->accumulator.values[perspective];
+        Square kingSquare = perspective == Color::WHITE ? this->whiteKingPosition : this->blackKingPosition;
+
+        //3) Every feature is relative to the king, so moving it invalidates that side's accumulator
+        if (movingPiece == PieceType::KING && perspective == movedColor) {
+            this->refreshAccumulator(perspective);
+            continue;
+        }
+
+        if (movingPiece != PieceType::KING) {
+            RemoveNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, movedColor, movingPiece, src));
+            AddNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, movedColor, placedPiece, dst));
+        }
+        else if (isCastle) {
+            RemoveNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, movedColor, PieceType::ROOK, rookSrc));
+            AddNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, movedColor, PieceType::ROOK, rookDst));
+        }
+
+        if (capturedPiece != PieceType::NO_PIECE) {
+            RemoveNetworkFeature(values, GetNetworkFeature(perspective, kingSquare, otherColor, capturedPiece, capturedSquare));
+        }
+    }
 }
 
 void ChessBoard::resetSpecificPositionImplementation(const std::string& fen)
@@ -30,17 +30,24 @@
 
 #include "../../game/types/bitboard.h"
 
+#include "../eval/network.h"
+
 #include "../types/castlerights.h"
 #include "../types/move.h"
 #include "../types/nodetype.h"
 #include "../types/piece.h"
+#include "../types/score.h"
 
 class ChessBoard : public GameBoard<ChessBoard, ChessMove>
 {
 protected:
+    template<bool performPreCalculations = true>
     void buildAttackBoards();
     void buildBitboardsFromMailbox();
     void clearEverything();
+    void countPieces();
+    void refreshAccumulator(Color perspective);
+    void updateAccumulators(ChessMove& move, Square oldEnPassant);
 public:
     Bitboard whitePieces[PieceType::PIECETYPE_COUNT];
     Bitboard blackPieces[PieceType::PIECETYPE_COUNT];
@@ -53,10 +60,17 @@ public:
     NodeCount fullMoveCount;
 
     Bitboard blockedPieces, checkingPieces, inBetweenSquares, pinnedPieces;
+    Bitboard checkSquares[PieceType::PIECETYPE_COUNT], discoveredCheckPieces;
 
     Hash hashValue, materialHashValue, pawnHashValue;
 
-    Evaluation materialEvaluation, pstEvaluation;
+    ChessEvaluation materialEvaluation, pstEvaluation;
+
+    //Piece counts per side, with the side's total under PieceType::ALL, and the number of pieces on the board.  The total
+    //  is what TaperEvaluation interpolates over, and what the endgame and bitbase probes check against.
+    std::int32_t pieceCounts[Color::COLOR_COUNT][PieceType::PIECETYPE_COUNT];
+    std::int32_t pieceCount;
+    NetworkAccumulator accumulator;
     
     CastleRights castleRights;
     Color sideToMove;
@@ -72,9 +86,9 @@ public:
 
     Hash calculateHash();
     Hash calculateMaterialHash();
-    Evaluation calculateMaterialEvaluation();
+    ChessEvaluation calculateMaterialEvaluation();
     Hash calculatePawnHash();
-    Evaluation calculatePstEvaluation();
+    ChessEvaluation calculatePstEvaluation();
 
     template<bool performPreCalculations = true>
     void doMoveImplementation(ChessMove& move);
@@ -84,6 +98,8 @@ public:
 
     void initFromFen(const std::string& fen);
 
+    void refreshAccumulators();
+
     void resetSpecificPositionImplementation(const std::string& fen);
     void resetStartingPositionImplementation();
 };
@@ -31,9 +31,12 @@
 
 #include "moves.h"
 
+#include "../eval/parameters.h"
+
 static constexpr bool enableButterflyTable = true;
 
 extern Bitboard bbFile[File::FILE_COUNT];
+extern Bitboard bbRank[Rank::RANK_COUNT];
 
 extern Bitboard WhitePawnMoves[Square::SQUARE_COUNT];
 extern Bitboard WhitePawnCaptures[Square::SQUARE_COUNT];
@@ -42,8 +45,6 @@ extern Bitboard BlackPawnCaptures[Square::SQUARE_COUNT];
 extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
 extern Bitboard InBetween[Square::SQUARE_COUNT][Square::SQUARE_COUNT];
 
-extern Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT];
-
 static ChessPrincipalVariation principalVariation;
 static MoveList<ChessMoveGenerator::MoveType> PerftMoveList[Depth::MAX];
 
@@ -51,6 +52,7 @@ ChessMoveGenerator::ChessMoveGenerator()
 {
     SetupInBetweenBoard();
     SetupPassedPawnCheckBoard();
+    SetupSliderRays();
 }
 
 ChessMoveGenerator::~ChessMoveGenerator()
@@ -58,11 +60,43 @@ ChessMoveGenerator::~ChessMoveGenerator()
 
 }
 
-NodeCount ChessMoveGenerator::doubleCheckGeneratedMoves(BoardType& board, MoveList<MoveType>& moveList)
+NodeCount ChessMoveGenerator::addPawnMoves(MoveList<MoveType>& moveList, Bitboard dstSquares, Bitboard promotionSquares, Direction direction, bool countOnly)
 {
-    NodeCount moveCount = moveList.size();
+    Bitboard promotionMoves = dstSquares & promotionSquares;
+    Bitboard normalMoves = dstSquares & ~promotionSquares;
+
+    if (countOnly) {
+        return popCount(normalMoves) + 4 * popCount(promotionMoves);
+    }
+
+    //The source square is found by stepping back from the destination square
+    Direction backward = direction * -1;
+
+    Square dst;
+    while (BitScanForward64((std::uint32_t*) & dst, promotionMoves)) {
+        promotionMoves = ResetLowestSetBit(promotionMoves);
+
+        Square src = dst + backward;
+
+        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::QUEEN });
+        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::ROOK });
+        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::BISHOP });
+        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::KNIGHT });
+    }
+
+    while (BitScanForward64((std::uint32_t*) & dst, normalMoves)) {
+        normalMoves = ResetLowestSetBit(normalMoves);
+
+        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, dst + backward, dst, PieceType::NO_PIECE });
+    }
 
-    MoveList<MoveType>::iterator it = moveList.begin();
+    return ZeroNodes;
+}
+
+//Only the moves from firstMove on are checked; the ones before it were already checked when they were generated
+NodeCount ChessMoveGenerator::doubleCheckGeneratedMoves(BoardType& board, MoveList<MoveType>& moveList, NodeCount firstMove)
+{
+    MoveList<MoveType>::iterator it = moveList.begin() + firstMove;
     while (it != moveList.end()) {
         MoveType& move = (*it);
 
@@ -108,77 +142,86 @@ NodeCount ChessMoveGenerator::generateAllCaptures(BoardType& board, MoveList<Mov
     Bitboard* piecesToMove = whiteToMove ? board.whitePieces : board.blackPieces;
     Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
 
-    Bitboard srcPieces = piecesToMove[PieceType::ALL];
-    Bitboard dstMoves;
+    //3) Captures are generated from the most valuable victim down to the least valuable, and for each victim from the least
+    //	valuable attacker up to the king.  This is MVV/LVA order, so quiescence search doesn't need to sort the moves.
+    bool bishopFirst = MaterialParameters[PieceType::BISHOP].mg >= MaterialParameters[PieceType::KNIGHT].mg;
 
-    Square src, dst;
+    PieceType victimOrder[] = {
+        PieceType::QUEEN,
+        PieceType::ROOK,
+        bishopFirst ? PieceType::BISHOP : PieceType::KNIGHT,
+        bishopFirst ? PieceType::KNIGHT : PieceType::BISHOP,
+        PieceType::PAWN
+    };
 
-    while (BitScanForward64((std::uint32_t*) & src, srcPieces)) {
-        srcPieces = ResetLowestSetBit(srcPieces);
+    Bitboard pawns = piecesToMove[PieceType::PAWN];
 
-        PieceType movingPiece = board.pieces[src];
+    Square src, dst;
 
-        if (movingPiece == PieceType::PAWN) {
-            dstMoves = whiteToMove ? WhitePawnCaptures[src] : BlackPawnCaptures[src];
+    for (PieceType victim : victimOrder) {
+        Bitboard victims = otherPieces[victim];
+        Bitboard pawnVictims = victims;
 
-            //Special en passant processing here (add the move to dstMoves)
-            if (board.enPassant != Square::NO_SQUARE) {
-                if (((whiteToMove ? WhitePawnCaptures[src] : BlackPawnCaptures[src]) & OneShiftedBy(board.enPassant)) != EmptyBitboard) {
-                    dstMoves |= OneShiftedBy(board.enPassant);
-                }
-            }
-        }
-        else {
-            dstMoves = PieceMoves[movingPiece][src];
+        //Only pawns may capture en passant
+        if (victim == PieceType::PAWN
+            && board.enPassant != Square::NO_SQUARE) {
+            pawnVictims |= OneShiftedBy(board.enPassant);
         }
 
-        //Don't allow us to capture our own pieces
-        dstMoves &= otherPieces[PieceType::ALL];
-
-        //If this piece is pinned, it's destination moves can only be other squares in between attackers (in this case, blocked pieces)
-        if ((OneShiftedBy(src) & board.pinnedPieces) != EmptyBitboard) {
-            dstMoves &= board.blockedPieces;
+        if (pawnVictims == EmptyBitboard) {
+            continue;
         }
 
-        while (BitScanForward64((std::uint32_t*) & dst, dstMoves)) {
-            dstMoves = ResetLowestSetBit(dstMoves);
+        //4) Pawns are generated all at once rather than one at a time.  Pinned pawns may only capture blocked pieces.
+        this->generatePawnMoves(board, moveList, pawns & ~board.pinnedPieces, pawnVictims, true, false);
+        this->generatePawnMoves(board, moveList, pawns & board.pinnedPieces, pawnVictims & board.blockedPieces, true, false);
 
-            switch (movingPiece) {
-            case PieceType::PAWN:
-            {
-                Rank rank = getRank(dst);
+        //5) Every other piece looks back from the victim's square to find its attackers
+        for (PieceType attacker = PieceType::KNIGHT; attacker <= PieceType::KING; attacker++) {
+            Bitboard attackers = piecesToMove[attacker];
 
-                if (rank == (whiteToMove ? Rank::_8 : Rank::_1)) {
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::QUEEN });
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::ROOK });
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::BISHOP });
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::KNIGHT });
-                }
-                else {
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
-                }
+            if (attackers == EmptyBitboard) {
+                continue;
             }
-            break;
-            case PieceType::KNIGHT:
-                //We know this is either an empty space or a capture move; there can't be anything in between so allow the move;
-                moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
-                break;
-            case PieceType::KING:
-                //Can't move king into check
-                if (!this->attackGenerator.isSquareAttacked(board, dst)) {
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+
+            Bitboard dstSquares = victims;
+
+            while (BitScanForward64((std::uint32_t*) & dst, dstSquares)) {
+                dstSquares = ResetLowestSetBit(dstSquares);
+
+                Bitboard srcSquares = PieceMoves[attacker][dst] & attackers;
+
+                //If the attacker is pinned, it can only capture other squares in between attackers (in this case, blocked pieces)
+                if ((OneShiftedBy(dst) & board.blockedPieces) == EmptyBitboard) {
+                    srcSquares &= ~board.pinnedPieces;
                 }
-                break;
-            default:
-                //We know this is either an empty space or a capture move; just make sure there's nothing in between
-                if ((board.allPieces & InBetween[src][dst]) == EmptyBitboard) {
-                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+
+                while (BitScanForward64((std::uint32_t*) & src, srcSquares)) {
+                    srcSquares = ResetLowestSetBit(srcSquares);
+
+                    switch (attacker) {
+                    case PieceType::KNIGHT:
+                        //There can't be anything in between so allow the move
+                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                        break;
+                    case PieceType::KING:
+                        //Can't move king into check
+                        if (!this->attackGenerator.isSquareAttacked(board, dst)) {
+                            moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                        }
+                        break;
+                    default:
+                        //Make sure there's nothing in between
+                        if ((board.allPieces & InBetween[src][dst]) == EmptyBitboard) {
+                            moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                        }
+                    }
                 }
             }
         }
     }
 
-    //3) There are very rare instances where a pinned piece move or en passant move is errantly generated.  Resort to manual double checking of those moves.
+    //6) There are very rare instances where a pinned piece move or en passant move is errantly generated.  Resort to manual double checking of those moves.
     if (this->shouldDoubleCheckGeneratedMoves(board)) {
         this->doubleCheckGeneratedMoves(board, moveList);
     }
@@ -211,9 +254,13 @@ NodeCount ChessMoveGenerator::generateAllMovesImplementation(BoardType& board, M
     bool whiteToMove = board.sideToMove == Color::WHITE;
 
     Bitboard piecesToMove = whiteToMove ? board.whitePieces[PieceType::ALL] : board.blackPieces[PieceType::ALL];
-    Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
+    Bitboard pawns = whiteToMove ? board.whitePieces[PieceType::PAWN] : board.blackPieces[PieceType::PAWN];
 
-    Bitboard srcPieces = piecesToMove;
+    //Pawns are generated all at once rather than one at a time.  Pinned pawns may only move to squares in between attackers.
+    moveCount += this->generatePawnMoves(board, moveList, pawns & ~board.pinnedPieces, ~EmptyBitboard, false, countOnly);
+    moveCount += this->generatePawnMoves(board, moveList, pawns & board.pinnedPieces, board.inBetweenSquares | board.blockedPieces, false, countOnly);
+
+    Bitboard srcPieces = piecesToMove & ~pawns;
     Bitboard dstMoves;
 
     Square src, dst;
@@ -225,23 +272,6 @@ NodeCount ChessMoveGenerator::generateAllMovesImplementation(BoardType& board, M
         dstMoves = PieceMoves[movingPiece][src];
 
         switch (movingPiece) {
-        case PieceType::PAWN:
-            dstMoves = (whiteToMove ? WhitePawnMoves[src] : BlackPawnMoves[src]) & ~board.allPieces;
-            dstMoves |= (whiteToMove ? WhitePawnCaptures[src] : BlackPawnCaptures[src]) & otherPieces[PieceType::ALL];
-
-            //If we're advancing by 2, make sure we're not blocked
-            if (getRank(src) == (whiteToMove ? Rank::_2 : Rank::_7)) {
-                dstMoves &= ~(whiteToMove ? (board.allPieces & 0x0000ff0000000000ull) >> 8 : (board.allPieces & 0x0000000000ff0000ull) << 8);
-            }
-
-            //Special en passant processing here (add the move to dstMoves)
-            if (board.enPassant != Square::NO_SQUARE) {
-                if (((whiteToMove ? WhitePawnCaptures[src] : BlackPawnCaptures[src]) & OneShiftedBy(board.enPassant)) != EmptyBitboard) {
-                    dstMoves |= OneShiftedBy(board.enPassant);
-                }
-            }
-
-            break;
         case PieceType::KING:
             //Special castle processing here
             //We don't have to do the IsInCheck check because if the king is in check, a specialized function is called for it.
@@ -295,27 +325,6 @@ NodeCount ChessMoveGenerator::generateAllMovesImplementation(BoardType& board, M
             dstMoves = ResetLowestSetBit(dstMoves);
 
             switch (movingPiece) {
-            case PieceType::PAWN:
-                if (getRank(dst) == (whiteToMove ? Rank::_8 : Rank::_1)) {
-                    if (countOnly) {
-                        moveCount += 4;
-                    }
-                    else {
-                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::QUEEN });
-                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::ROOK });
-                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::BISHOP });
-                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::KNIGHT });
-                    }
-                }
-                else {
-                    if (countOnly) {
-                        moveCount ++;
-                    }
-                    else {
-                        moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
-                    }
-                }
-                break;
             case PieceType::KNIGHT:
                 if (countOnly) {
                     moveCount++;
@@ -578,6 +587,154 @@ NodeCount ChessMoveGenerator::generateMovesToSquares(BoardType& board, MoveList<
     return moveList.size();
 }
 
+NodeCount ChessMoveGenerator::generateQuietChecks(BoardType& board, MoveList<MoveType>& moveList)
+{
+    //Quiet checks are added to the end of the move list so they can follow the captures in quiescence search.  The side to
+    //	move must not be in check.
+    NodeCount captureCount = moveList.size();
+
+    bool whiteToMove = board.sideToMove == Color::WHITE;
+
+    Bitboard* piecesToMove = whiteToMove ? board.whitePieces : board.blackPieces;
+    Square otherKingPosition = whiteToMove ? board.blackKingPosition : board.whiteKingPosition;
+
+    Bitboard pinnedSquares = board.inBetweenSquares | board.blockedPieces;
+    Bitboard promotionSquares = whiteToMove ? bbRank[Rank::_8] : bbRank[Rank::_1];
+
+    Bitboard quietSquares = ~board.allPieces;
+
+    //1) Pawns push onto direct check squares.  Pawns discovering check may push anywhere, unless they're on the same file as the king.
+    //	Promotions and the en passant square are left to capture generation.
+    Bitboard pawns = piecesToMove[PieceType::PAWN];
+    Bitboard discoveringPawns = pawns & board.discoveredCheckPieces & ~bbFile[getFile(otherKingPosition)];
+    Bitboard checkingPawns = pawns & ~discoveringPawns;
+
+    Bitboard pawnQuietSquares = quietSquares & ~promotionSquares;
+
+    if (board.enPassant != Square::NO_SQUARE) {
+        pawnQuietSquares &= ~OneShiftedBy(board.enPassant);
+    }
+
+    Bitboard pawnCheckSquares = pawnQuietSquares & board.checkSquares[PieceType::PAWN];
+
+    this->generatePawnMoves(board, moveList, checkingPawns & ~board.pinnedPieces, pawnCheckSquares, false, false);
+    this->generatePawnMoves(board, moveList, checkingPawns & board.pinnedPieces, pawnCheckSquares & pinnedSquares, false, false);
+    this->generatePawnMoves(board, moveList, discoveringPawns & ~board.pinnedPieces, pawnQuietSquares, false, false);
+    this->generatePawnMoves(board, moveList, discoveringPawns & board.pinnedPieces, pawnQuietSquares & pinnedSquares, false, false);
+
+    //2) Every other piece moves onto a direct check square, or anywhere off the line to the king if it's discovering check
+    Bitboard srcPieces = piecesToMove[PieceType::ALL] & ~pawns;
+    Bitboard dstMoves;
+
+    Square src, dst;
+
+    while (BitScanForward64((std::uint32_t*) & src, srcPieces)) {
+        srcPieces = ResetLowestSetBit(srcPieces);
+
+        PieceType movingPiece = board.pieces[src];
+        bool isDiscoveringCheck = (board.discoveredCheckPieces & OneShiftedBy(src)) != EmptyBitboard;
+
+        dstMoves = PieceMoves[movingPiece][src] & quietSquares;
+
+        if (!isDiscoveringCheck) {
+            dstMoves &= board.checkSquares[movingPiece];
+        }
+
+        //If this piece is pinned, it's destination moves can only be other squares in between attackers
+        if ((OneShiftedBy(src) & board.pinnedPieces) != EmptyBitboard) {
+            dstMoves &= pinnedSquares;
+        }
+
+        while (BitScanForward64((std::uint32_t*) & dst, dstMoves)) {
+            dstMoves = ResetLowestSetBit(dstMoves);
+
+            //A discovering piece which stays on the line to the king must give check directly
+            if (isDiscoveringCheck
+                && (board.checkSquares[movingPiece] & OneShiftedBy(dst)) == EmptyBitboard
+                && ((InBetween[otherKingPosition][src] & OneShiftedBy(dst)) != EmptyBitboard
+                    || (InBetween[otherKingPosition][dst] & OneShiftedBy(src)) != EmptyBitboard)) {
+                continue;
+            }
+
+            switch (movingPiece) {
+            case PieceType::KNIGHT:
+                moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                break;
+            case PieceType::KING:
+                //Can't move king into check
+                if (!this->attackGenerator.isSquareAttacked(board, dst)) {
+                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                }
+                break;
+            default:
+                //Make sure there's nothing in between
+                if ((board.allPieces & InBetween[src][dst]) == EmptyBitboard) {
+                    moveList.push_back({ ChessMoveOrdinal::NO_CHESS_MOVE_ORDINAL, src, dst, PieceType::NO_PIECE });
+                }
+            }
+        }
+    }
+
+    //3) There are very rare instances where a pinned piece move is errantly generated.  Resort to manual double checking of those moves.
+    //	The captures were already checked by generateAllCaptures.
+    if (this->shouldDoubleCheckGeneratedMoves(board)) {
+        this->doubleCheckGeneratedMoves(board, moveList, captureCount);
+    }
+
+    return moveList.size();
+}
+
+NodeCount ChessMoveGenerator::generatePawnMoves(BoardType& board, MoveList<MoveType>& moveList, Bitboard pawns, Bitboard dstSquares, bool capturesOnly, bool countOnly)
+{
+    if (pawns == EmptyBitboard) {
+        return ZeroNodes;
+    }
+
+    bool whiteToMove = board.sideToMove == Color::WHITE;
+
+    Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
+
+    Direction up = whiteToMove ? Direction::UP : Direction::DOWN;
+    Direction twoUp = whiteToMove ? Direction::TWO_UP : Direction::TWO_DOWN;
+    Direction left = whiteToMove ? Direction::UP_LEFT : Direction::DOWN_LEFT;
+    Direction right = whiteToMove ? Direction::UP_RIGHT : Direction::DOWN_RIGHT;
+
+    Bitboard doublePushSquares = whiteToMove ? bbRank[Rank::_3] : bbRank[Rank::_6];
+    Bitboard promotionSquares = whiteToMove ? bbRank[Rank::_8] : bbRank[Rank::_1];
+
+    NodeCount moveCount = ZeroNodes;
+
+    //1) Captures, including en passant, are shifted diagonally onto the other side's pieces
+    Bitboard captureSquares = otherPieces[PieceType::ALL];
+
+    if (board.enPassant != Square::NO_SQUARE) {
+        captureSquares |= OneShiftedBy(board.enPassant);
+    }
+
+    captureSquares &= dstSquares;
+
+    Bitboard leftCaptures = ((pawns & ~bbFile[File::_A]) + left) & captureSquares;
+    Bitboard rightCaptures = ((pawns & ~bbFile[File::_H]) + right) & captureSquares;
+
+    moveCount += this->addPawnMoves(moveList, leftCaptures, promotionSquares, left, countOnly);
+    moveCount += this->addPawnMoves(moveList, rightCaptures, promotionSquares, right, countOnly);
+
+    if (capturesOnly) {
+        return moveCount;
+    }
+
+    //2) Pushes are shifted forward onto empty squares.  Only single pushes landing on the third rank may push again.
+    Bitboard emptySquares = ~board.allPieces;
+
+    Bitboard singlePushes = (pawns + up) & emptySquares;
+    Bitboard doublePushes = ((singlePushes & doublePushSquares) + up) & emptySquares;
+
+    moveCount += this->addPawnMoves(moveList, singlePushes & dstSquares, promotionSquares, up, countOnly);
+    moveCount += this->addPawnMoves(moveList, doublePushes & dstSquares, EmptyBitboard, twoUp, countOnly);
+
+    return moveCount;
+}
+
 NodeCount ChessMoveGenerator::perft(BoardType& board, Depth maxDepth, Depth currentDepth)
 {
     NodeCount result = ZeroNodes;
@@ -622,7 +779,7 @@ NodeCount ChessMoveGenerator::perft(BoardType& board, Depth maxDepth, Depth curr
 }
 
 template <NodeType nodeType>
-void ChessMoveGenerator::reorderMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable)
+void ChessMoveGenerator::reorderMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable, ChessCaptureHistory& captureHistory)
 {
     bool whiteToMove = board.sideToMove == Color::WHITE;
 
@@ -650,18 +807,20 @@ void ChessMoveGenerator::reorderMoves(BoardType& board, MoveList<MoveType>& move
             && nodeType == NodeType::PV_NODETYPE) {
             move.ordinal = ChessMoveOrdinal::PV_MOVE;
         }
+        else if (searchStack.hashMove == move) {
+            move.ordinal = ChessMoveOrdinal::HASH_MOVE;
+        }
         else if (capturedPiece != PieceType::NO_PIECE) {
-            Evaluation capturedPieceEvaluation = MaterialParameters[capturedPiece];
-            Evaluation movingPieceEvaluation = MaterialParameters[movingPiece];
+            //Within each bucket, the most valuable victim goes first, adjusted by how well the capture has done before.
+            //  SEE decides the bucket; winning a more valuable piece can't lose material, so it skips the SEE.
+            Score captureScore = 16 * MaterialParameters[capturedPiece].mg + captureHistory.get(movingPiece, dst, capturedPiece) / 4;
 
-            if (capturedPieceEvaluation.mg > movingPieceEvaluation.mg) {
-                move.ordinal = ChessMoveOrdinal::GOOD_CAPTURE_MOVE;
-            }
-            else if (capturedPieceEvaluation.mg == movingPieceEvaluation.mg) {
-                move.ordinal = ChessMoveOrdinal::EQUAL_CAPTURE_MOVE;
+            if (MaterialParameters[capturedPiece].mg > MaterialParameters[movingPiece].mg
+                || this->attackGenerator.seeGreaterOrEqual(board, move, ZERO_SCORE)) {
+                move.ordinal = ChessMoveOrdinal::GOOD_CAPTURE_MOVE + ChessMoveOrdinal(captureScore);
             }
             else {
-                move.ordinal = ChessMoveOrdinal::BAD_CAPTURE_MOVE;
+                move.ordinal = ChessMoveOrdinal::BAD_CAPTURE_MOVE + ChessMoveOrdinal(captureScore);
             }
         }
         else if (searchStack.killer1 == move) {
@@ -670,13 +829,23 @@ void ChessMoveGenerator::reorderMoves(BoardType& board, MoveList<MoveType>& move
         else if (searchStack.killer2 == move) {
             move.ordinal = ChessMoveOrdinal::KILLER2_MOVE;
         }
+        else if (searchStack.counterMove == move) {
+            move.ordinal = ChessMoveOrdinal::COUNTER_MOVE;
+        }
         else if (movingPiece != PieceType::PAWN
             && (unsafeSquares & OneShiftedBy(src)) != EmptyBitboard) {
             move.ordinal = ChessMoveOrdinal::UNSAFE_MOVE;
         }
         else {
             if (enableButterflyTable) {
-                std::uint32_t butterflyScore = butterflyTable.get(movingPiece, dst);
+                //The butterfly and continuation histories share one scale, so they simply add up
+                std::int32_t butterflyScore = butterflyTable.get(board.sideToMove, movingPiece, dst);
+
+                for (PieceSquareHistory* continuationHistory : searchStack.continuationHistory) {
+                    if (continuationHistory != nullptr) {
+                        butterflyScore += (*continuationHistory)[movingPiece][dst];
+                    }
+                }
 
                 move.ordinal = ChessMoveOrdinal::BUTTERFLY_MOVE + ChessMoveOrdinal(butterflyScore);
             }
@@ -687,52 +856,12 @@ void ChessMoveGenerator::reorderMoves(BoardType& board, MoveList<MoveType>& move
     }
 }
 
-template <NodeType nodeType>
-void ChessMoveGenerator::reorderQuiescenceMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack)
-{
-    bool whiteToMove = board.sideToMove == Color::WHITE;
-
-    Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
-
-    Direction left = whiteToMove ? Direction::DOWN_LEFT : Direction::UP_LEFT;
-    Direction right = whiteToMove ? Direction::DOWN_RIGHT : Direction::UP_RIGHT;
-
-    Bitboard unsafeSquares = ((otherPieces[PieceType::PAWN] & ~bbFile[File::_A]) + left) | ((otherPieces[PieceType::PAWN] & ~bbFile[File::_H]) + right);
-
-    for (MoveList<MoveType>::iterator it = moveList.begin(); it != moveList.end(); ++it) {
-        MoveType& move = (*it);
-
-        Square src = move.src;
-        Square dst = move.dst;
-
-        PieceType movingPiece = board.pieces[src];
-        PieceType capturedPiece = board.pieces[dst];
-
-        if (movingPiece != PieceType::PAWN
-            && (unsafeSquares & OneShiftedBy(src)) != EmptyBitboard) {
-            move.ordinal = ChessMoveOrdinal::UNSAFE_MOVE;
-        }
-        else {
-            Evaluation capturedPieceEvaluation = MaterialParameters[capturedPiece];
-            Evaluation movingPieceEvaluation = MaterialParameters[movingPiece];
-
-            move.ordinal = ChessMoveOrdinal::QUIESENCE_MOVE + ChessMoveOrdinal(1024 * capturedPieceEvaluation.mg - movingPieceEvaluation.mg);
-        }
-    }
-
-    std::stable_sort(moveList.begin(), moveList.end(), greater<MoveType>);
-}
-
 bool ChessMoveGenerator::shouldDoubleCheckGeneratedMoves(BoardType& board)
 {
     return (board.pinnedPieces != EmptyBitboard)
         || (board.enPassant != Square::NO_SQUARE);
 }
 
-template void ChessMoveGenerator::reorderMoves<NodeType::PV_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable);
-template void ChessMoveGenerator::reorderMoves<NodeType::ALL_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable);
-template void ChessMoveGenerator::reorderMoves<NodeType::CUT_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable);
-
-template void ChessMoveGenerator::reorderQuiescenceMoves<NodeType::PV_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack);
-template void ChessMoveGenerator::reorderQuiescenceMoves<NodeType::ALL_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack);
-template void ChessMoveGenerator::reorderQuiescenceMoves<NodeType::CUT_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack);
+template void ChessMoveGenerator::reorderMoves<NodeType::PV_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable, ChessCaptureHistory& captureHistory);
+template void ChessMoveGenerator::reorderMoves<NodeType::ALL_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable, ChessCaptureHistory& captureHistory);
+template void ChessMoveGenerator::reorderMoves<NodeType::CUT_NODETYPE>(ChessBoard& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable, ChessCaptureHistory& captureHistory);
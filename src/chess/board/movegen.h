@@ -27,6 +27,7 @@
 #include "board.h"
 
 #include "../search/butterfly.h"
+#include "../search/capturehistory.h"
 #include "../search/chesspv.h"
 
 #include "../types/search.h"
@@ -44,23 +45,24 @@ protected:
     bool shouldDoubleCheckGeneratedMoves(BoardType& board);
 public:
     using MoveType = typename ChessBoard::MoveType;
-
+protected:
+    NodeCount addPawnMoves(MoveList<MoveType>& moveList, Bitboard dstSquares, Bitboard promotionSquares, Direction direction, bool countOnly);
+    NodeCount generatePawnMoves(BoardType& board, MoveList<MoveType>& moveList, Bitboard pawns, Bitboard dstSquares, bool capturesOnly, bool countOnly);
+public:
     ChessMoveGenerator();
     ~ChessMoveGenerator();
 
-    NodeCount doubleCheckGeneratedMoves(BoardType& board, MoveList<MoveType>& moveList);
+    NodeCount doubleCheckGeneratedMoves(BoardType& board, MoveList<MoveType>& moveList, NodeCount firstMove = ZeroNodes);
 
     NodeCount generateAllCaptures(BoardType& board, MoveList<MoveType>& moveList);
     NodeCount generateAllMovesImplementation(BoardType& board, MoveList<MoveType>& moveList, bool countOnly);
     NodeCount generateAttacksOnSquares(BoardType& board, MoveList<MoveType>& moveList, Bitboard dstSquares, Bitboard excludeSrcSquares);
     NodeCount generateCheckEvasions(BoardType& board, MoveList<MoveType>& moveList);
     NodeCount generateMovesToSquares(BoardType& board, MoveList<MoveType>& moveList, Bitboard dstSquares, Bitboard excludeSrcSquares);
+    NodeCount generateQuietChecks(BoardType& board, MoveList<MoveType>& moveList);
 
     NodeCount perft(BoardType& board, Depth maxDepth, Depth currentDepth);
 
     template <NodeType nodeType>
-    void reorderMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable);
-
-    template <NodeType nodeType>
-    void reorderQuiescenceMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack);
+    void reorderMoves(BoardType& board, MoveList<MoveType>& moveList, SearchStack& searchStack, ChessButterflyTable& butterflyTable, ChessCaptureHistory& captureHistory);
 };
@@ -163,6 +163,9 @@ Bitboard InBetween[Square::SQUARE_COUNT][Square::SQUARE_COUNT];
 Bitboard PassedPawnCheck[Square::SQUARE_COUNT];
 Bitboard SquaresInFront[Square::SQUARE_COUNT];
 
+//The first four rays point toward higher squares, the last four toward lower squares.  Even rays are diagonal, odd rays are straight.
+static Bitboard SliderRays[8][Square::SQUARE_COUNT];
+
 bool IsOnBoard(Square src, Direction dr, Direction df)
 {
     Rank rank = getRank(src);
@@ -177,6 +180,39 @@ bool IsOnBoard(Square src, Direction dr, Direction df)
     return true;
 }
 
+static Bitboard RayAttacks(std::int32_t ray, Square src, Bitboard occupied)
+{
+    Bitboard rayBitboard = SliderRays[ray][src];
+    Bitboard blockers = rayBitboard & occupied;
+
+    //1) Toward higher squares, the nearest blocker is the lowest set bit.  Everything past it is out of reach.
+    if (ray < 4) {
+        Bitboard nearestBlocker = blockers & (0 - blockers);
+
+        return rayBitboard & ((nearestBlocker << 1) - 1);
+    }
+
+    //2) Toward lower squares, the nearest blocker is the highest set bit.  Smear it downward to cover everything past it.
+    blockers |= blockers >> 1;
+    blockers |= blockers >> 2;
+    blockers |= blockers >> 4;
+    blockers |= blockers >> 8;
+    blockers |= blockers >> 16;
+    blockers |= blockers >> 32;
+
+    return rayBitboard & ~(blockers >> 1);
+}
+
+Bitboard BishopAttacks(Square src, Bitboard occupied)
+{
+    return RayAttacks(0, src, occupied) | RayAttacks(2, src, occupied) | RayAttacks(4, src, occupied) | RayAttacks(6, src, occupied);
+}
+
+Bitboard RookAttacks(Square src, Bitboard occupied)
+{
+    return RayAttacks(1, src, occupied) | RayAttacks(3, src, occupied) | RayAttacks(5, src, occupied) | RayAttacks(7, src, occupied);
+}
+
 static bool isInBetweenBoardSetup = false;
 
 void SetupInBetweenBoard()
@@ -322,3 +358,31 @@ void SetupPassedPawnCheckBoard()
 
     isPassedPawnCheckBoardSetup = true;
 }
+
+static bool isSliderRaysSetup = false;
+
+void SetupSliderRays()
+{
+    if (isSliderRaysSetup) {
+        return;
+    }
+
+    constexpr Direction rankDirections[8] = { Direction::DOWN, Direction::DOWN, Direction::DOWN, Direction::NO_DIRECTION, Direction::UP, Direction::UP, Direction::UP, Direction::NO_DIRECTION };
+    constexpr Direction fileDirections[8] = { Direction::LEFT, Direction::NO_DIRECTION, Direction::RIGHT, Direction::RIGHT, Direction::RIGHT, Direction::NO_DIRECTION, Direction::LEFT, Direction::LEFT };
+
+    for (Square src = Square::FIRST_SQUARE; src < Square::SQUARE_COUNT; src++) {
+        for (std::int32_t ray = 0; ray < 8; ray++) {
+            Bitboard currentRay = EmptyBitboard;
+
+            int j = 1;
+            while (IsOnBoard(src, rankDirections[ray] * j, fileDirections[ray] * j)) {
+                currentRay |= OneShiftedBy(src + rankDirections[ray] * j + fileDirections[ray] * j);
+                j++;
+            }
+
+            SliderRays[ray][src] = currentRay;
+        }
+    }
+
+    isSliderRaysSetup = true;
+}
@@ -22,5 +22,9 @@
 
 bool IsOnBoard(Square src, Direction dr, Direction df);
 
+Bitboard BishopAttacks(Square src, Bitboard occupied);
+Bitboard RookAttacks(Square src, Bitboard occupied);
+
 void SetupInBetweenBoard();
 void SetupPassedPawnCheckBoard();
+void SetupSliderRays();
@@ -25,6 +25,12 @@
 
 #include "../board/movegen.h"
 
+#include "../endgame/retrograde.h"
+#include "../endgame/wdl.h"
+
+#include "../eval/network.h"
+#include "../eval/parameters.h"
+
 #include "../../game/types/depth.h"
 #include "../../game/types/nodecount.h"
 
@@ -35,11 +41,46 @@ struct Command {
     void (*function)(XBoardComm* xboard, std::stringstream& cmd);
 };
 
+#ifndef USE_BAKED_PARAMETERS
+static void xboardBake(XBoardComm* xboard, std::stringstream& cmd)
+{
+    std::string headerFileName;
+    cmd >> headerFileName;
+
+    xboard->writeBakedParameters(headerFileName);
+}
+#endif
+
+//"bitbases <directory>" maps the WDL bitbases found there, "bitbases off" unmaps them
+static void xboardBitbases(XBoardComm* xboard, std::stringstream& cmd)
+{
+    std::string directory;
+    cmd >> directory;
+
+    xboard->loadBitbases(directory);
+}
+
+static void xboardEvalStats(XBoardComm* xboard, std::stringstream& cmd)
+{
+    xboard->printEvaluationStatistics();
+}
+
 static void xboardForce(XBoardComm* xboard, std::stringstream& cmd)
 {
     xboard->setForce(true);
 }
 
+//"generatebitbases <directory> [threads]" builds every WDL bitbase into the directory, using all cores by default
+static void xboardGenerateBitbases(XBoardComm* xboard, std::stringstream& cmd)
+{
+    std::string directory;
+    std::uint32_t threadCount = 0;
+
+    cmd >> directory >> threadCount;
+
+    xboard->generateBitbases(directory, threadCount);
+}
+
 static void xboardGo(XBoardComm* xboard, std::stringstream& cmd)
 {
     ChessMove playerMove;
@@ -98,6 +139,15 @@ static void xboardLevel(XBoardComm* xboard, std::stringstream& cmd)
     xboard->getPlayerClock().setClockLevel(moveCount, 1000 * seconds, 1000 * increment);
 }
 
+//"network <file>" switches to the neural network evaluator, "network off" switches back
+static void xboardNetwork(XBoardComm* xboard, std::stringstream& cmd)
+{
+    std::string networkFileName;
+    cmd >> networkFileName;
+
+    xboard->loadNetworkFile(networkFileName);
+}
+
 static void xboardNew(XBoardComm* xboard, std::stringstream& cmd)
 {
     xboard->resetStartingPosition();
@@ -157,6 +207,7 @@ static void xboardPerft(XBoardComm* xboard, std::stringstream& cmd)
     std::cout << "Time: " << time << " ms (" << nps << " nps)" << std::endl;
 }
 
+#ifndef USE_BAKED_PARAMETERS
 static void xboardPersonality(XBoardComm* xboard, std::stringstream& cmd)
 {
     std::string personalityFileName;
@@ -164,6 +215,7 @@ static void xboardPersonality(XBoardComm* xboard, std::stringstream& cmd)
 
     xboard->loadPersonalityFile(personalityFileName);
 }
+#endif
 
 static void xboardPing(XBoardComm* xboard, std::stringstream& cmd)
 {
@@ -194,6 +246,7 @@ static void xboardSetBoard(XBoardComm* xboard, std::stringstream& cmd)
     xboard->resetSpecificPosition(setboard);
 }
 
+#ifndef USE_BAKED_PARAMETERS
 static void xboardSetValue(XBoardComm* xboard, std::stringstream& cmd)
 {
     std::string name;
@@ -203,6 +256,7 @@ static void xboardSetValue(XBoardComm* xboard, std::stringstream& cmd)
 
     xboard->setParameter(name, score);
 }
+#endif
 
 static void xboardSn(XBoardComm* xboard, std::stringstream& cmd)
 {
@@ -260,19 +314,30 @@ static void xboardXboard(XBoardComm* xboard, std::stringstream& cmd)
 
 static struct Command XBoardCommandList[] =
 {
+#ifndef USE_BAKED_PARAMETERS
+    { "bake", xboardBake },
+#endif
+    { "bitbases", xboardBitbases },
+    { "evalstats", xboardEvalStats },
     { "force", xboardForce },
+    { "generatebitbases", xboardGenerateBitbases },
     { "go", xboardGo },
     { "level", xboardLevel },
+    { "network", xboardNetwork },
     { "new", xboardNew },
     { "nps", xboardNps },
     { "otim", xboardOtim },
     { "perft", xboardPerft },
+#ifndef USE_BAKED_PARAMETERS
     { "personality", xboardPersonality },
+#endif
     { "ping", xboardPing },
     { "quit", xboardQuit },
     { "sd", xboardSd },
     { "setboard", xboardSetBoard },
+#ifndef USE_BAKED_PARAMETERS
     { "setvalue", xboardSetValue },
+#endif
     { "sn", xboardSn },
     { "st", xboardSt },
     { "time", xboardTime },
@@ -297,6 +362,16 @@ void XBoardComm::doPlayerMove(ChessMove& playerMove)
     this->player.doMove(playerMove);
 }
 
+void XBoardComm::generateBitbases(std::string& directory, std::uint32_t threadCount)
+{
+    if (!GenerateBitbases(directory, threadCount)) {
+        std::cout << "Error (cannot generate bitbases): " << directory << std::endl;
+    }
+
+    //Positions scored before the tables existed are no longer exact
+    this->player.resetHashtable();
+}
+
 Clock& XBoardComm::getPlayerClock()
 {
     return this->player.getClock();
@@ -312,6 +387,32 @@ bool XBoardComm::isForced()
     return this->force;
 }
 
+void XBoardComm::loadBitbases(std::string& directory)
+{
+    if (directory == "off") {
+        UnloadBitbases();
+    }
+    else if (!LoadBitbases(directory)) {
+        std::cout << "Error (cannot load bitbases): " << directory << std::endl;
+    }
+
+    //Positions scored before the tables were loaded are no longer exact
+    this->player.resetHashtable();
+}
+
+void XBoardComm::loadNetworkFile(std::string& networkFileName)
+{
+    if (networkFileName == "off") {
+        NetworkEnabled = false;
+    }
+    else if (!LoadNetwork(networkFileName)) {
+        std::cout << "Error (cannot load network): " << networkFileName << std::endl;
+    }
+
+    //Scores from the other evaluator are no longer comparable
+    this->player.resetHashtable();
+}
+
 void XBoardComm::loadPersonalityFile(std::string& personalityFileName)
 {
     std::fstream personalityFile;
@@ -343,6 +444,11 @@ NodeCount XBoardComm::perft(Depth depth)
     return this->player.perft(depth);
 }
 
+void XBoardComm::printEvaluationStatistics()
+{
+    this->player.printEvaluationStatistics();
+}
+
 void XBoardComm::processCommandImplementation(std::string& cmd)
 {
 	struct Command* c = XBoardCommandList;
@@ -373,6 +479,7 @@ void XBoardComm::resetSpecificPosition(std::string& fen)
 void XBoardComm::resetStartingPosition()
 {
     this->player.resetStartingPosition();
+    this->player.resetStageMargins();
 }
 
 void XBoardComm::setForce(bool force)
@@ -389,3 +496,21 @@ void XBoardComm::undoPlayerMove()
 {
     this->player.undoMove();
 }
+
+#ifndef USE_BAKED_PARAMETERS
+void XBoardComm::writeBakedParameters(std::string& headerFileName)
+{
+    std::fstream headerFile;
+
+    headerFile.open(headerFileName, std::fstream::ios_base::out | std::fstream::ios_base::trunc);
+
+    if (!headerFile.is_open()) {
+        std::cout << "Error (cannot write parameters): " << headerFileName << std::endl;
+        return;
+    }
+
+    WriteBakedParameters(headerFile);
+
+    headerFile.close();
+}
+#endif
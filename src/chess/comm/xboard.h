@@ -36,14 +36,19 @@ public:
 
 	void doPlayerMove(ChessMove& playerMove);
 
+	void generateBitbases(std::string& directory, std::uint32_t threadCount);
+
 	Clock& getPlayerClock();
 	void getPlayerMove(ChessMove& playerMove);
 
 	bool isForced();
 
+	void loadBitbases(std::string& directory);
+	void loadNetworkFile(std::string& networkFileName);
 	void loadPersonalityFile(std::string& personalityFileName);
 
 	NodeCount perft(Depth depth);
+	void printEvaluationStatistics();
 
 	void processCommandImplementation(std::string& cmd);
 	
@@ -54,4 +59,8 @@ public:
 	void setParameter(std::string& name, Score score);
 
 	void undoPlayerMove();
+
+#ifndef USE_BAKED_PARAMETERS
+	void writeBakedParameters(std::string& headerFileName);
+#endif
 };
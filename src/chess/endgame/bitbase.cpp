@@ -0,0 +1,311 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "../../game/math/bitscan.h"
+
+#include "bitbase.h"
+#include "wdl.h"
+
+enum KpkResult : std::uint8_t {
+    KPK_INVALID, KPK_UNKNOWN, KPK_DRAW, KPK_WIN
+};
+
+static constexpr Direction KingDirections[] = {
+    Direction::UP_LEFT, Direction::UP, Direction::UP_RIGHT, Direction::LEFT,
+    Direction::RIGHT, Direction::DOWN_LEFT, Direction::DOWN, Direction::DOWN_RIGHT
+};
+
+static std::uint64_t KpkBitbase[KpkPositionCount / 64];
+static bool KpkBitbaseInitialized = false;
+
+static std::uint32_t KingDistance(Square s1, Square s2)
+{
+    return std::max(std::uint32_t(FileDistance(s1, s2)), std::uint32_t(RankDistance(s1, s2)));
+}
+
+static bool IsKingStep(Square src, Direction direction, Square& dst)
+{
+    dst = src + direction;
+
+    return dst >= Square::A8 && dst <= Square::H1 && FileDistance(src, dst) <= 1;
+}
+
+static bool PawnAttacks(Square pawn, Square dst)
+{
+    return getRank(dst) == getRank(pawn + Direction::UP) && FileDistance(pawn, dst) == 1;
+}
+
+//The pawn only ever stands on ranks 7 through 2 of files A-D, so it fits in 24 slots
+static std::uint32_t KpkIndex(bool whiteToMove, Square whiteKing, Square whitePawn, Square blackKing)
+{
+    std::uint32_t pawnIndex = std::uint32_t(getRank(whitePawn) - Rank::_7) * 4 + std::uint32_t(getFile(whitePawn));
+
+    assert(getFile(whitePawn) <= File::_D && pawnIndex < KpkPawnSquareCount);
+
+    return (((whiteToMove ? 0 : 1) * KpkPawnSquareCount + pawnIndex) * Square::SQUARE_COUNT + whiteKing) * Square::SQUARE_COUNT + blackKing;
+}
+
+//Classifies everything that can be decided without looking at the successors: illegal placements, pawns that promote
+//  safely, pawns that are captured, and stalemates.
+static KpkResult ClassifyKpk(bool whiteToMove, Square whiteKing, Square whitePawn, Square blackKing)
+{
+    //1) Illegal placements
+    if (whiteKing == blackKing || whiteKing == whitePawn || blackKing == whitePawn
+        || KingDistance(whiteKing, blackKing) <= 1
+        || (whiteToMove && PawnAttacks(whitePawn, blackKing))) {
+        return KPK_INVALID;
+    }
+
+    if (whiteToMove) {
+        //2) The pawn queens and the queen can't be taken
+        Square promotion = whitePawn + Direction::UP;
+
+        if (getRank(whitePawn) == Rank::_7
+            && promotion != whiteKing && promotion != blackKing
+            && (KingDistance(blackKing, promotion) > 1 || KingDistance(whiteKing, promotion) == 1)) {
+            return KPK_WIN;
+        }
+    }
+    else {
+        //3) Black takes an undefended pawn
+        if (KingDistance(blackKing, whitePawn) == 1 && KingDistance(whiteKing, whitePawn) > 1) {
+            return KPK_DRAW;
+        }
+
+        //4) Black is stalemated
+        bool hasMove = false;
+        Square dst;
+
+        for (Direction direction : KingDirections) {
+            if (IsKingStep(blackKing, direction, dst)
+                && KingDistance(dst, whiteKing) > 1
+                && !PawnAttacks(whitePawn, dst)) {
+                hasMove = true;
+                break;
+            }
+        }
+
+        if (!hasMove && !PawnAttacks(whitePawn, blackKing)) {
+            return KPK_DRAW;
+        }
+    }
+
+    return KPK_UNKNOWN;
+}
+
+//White wins if any move reaches a win, and draws once every move is known to draw.  Black is the reverse.
+static KpkResult RetrogradeKpk(const std::vector<KpkResult>& results, bool whiteToMove, Square whiteKing, Square whitePawn, Square blackKing)
+{
+    const KpkResult good = whiteToMove ? KPK_WIN : KPK_DRAW;
+    const KpkResult bad = whiteToMove ? KPK_DRAW : KPK_WIN;
+
+    bool allBad = true;
+    Square dst;
+
+    auto visit = [&](KpkResult result) {
+        if (result == good) {
+            return true;
+        }
+
+        allBad &= result == bad;
+
+        return false;
+    };
+
+    if (whiteToMove) {
+        //1) King moves
+        for (Direction direction : KingDirections) {
+            if (IsKingStep(whiteKing, direction, dst)
+                && dst != whitePawn
+                && KingDistance(dst, blackKing) > 1
+                && visit(results[KpkIndex(false, dst, whitePawn, blackKing)])) {
+                return good;
+            }
+        }
+
+        //2) Pawn pushes.  Promotions were settled by ClassifyKpk, and the ones it didn't call a win lose the queen.
+        Square push = whitePawn + Direction::UP;
+
+        if (getRank(whitePawn) != Rank::_7 && push != whiteKing && push != blackKing) {
+            if (visit(results[KpkIndex(false, whiteKing, push, blackKing)])) {
+                return good;
+            }
+
+            Square doublePush = push + Direction::UP;
+
+            if (getRank(whitePawn) == Rank::_2
+                && doublePush != whiteKing && doublePush != blackKing
+                && visit(results[KpkIndex(false, whiteKing, doublePush, blackKing)])) {
+                return good;
+            }
+        }
+    }
+    else {
+        //3) King moves.  Taking the pawn is only legal when it is undefended, which ClassifyKpk already called a draw.
+        for (Direction direction : KingDirections) {
+            if (IsKingStep(blackKing, direction, dst)
+                && dst != whitePawn
+                && KingDistance(dst, whiteKing) > 1
+                && !PawnAttacks(whitePawn, dst)
+                && visit(results[KpkIndex(true, whiteKing, whitePawn, dst)])) {
+                return good;
+            }
+        }
+    }
+
+    return allBad ? bad : KPK_UNKNOWN;
+}
+
+void InitializeKpkBitbase()
+{
+    if (KpkBitbaseInitialized) {
+        return;
+    }
+
+    std::vector<KpkResult> results(KpkPositionCount, KPK_INVALID);
+
+    //1) Seed every position that can be decided on its own
+    for (std::uint32_t side = 0; side < Color::COLOR_COUNT; side++) {
+        bool whiteToMove = side == Color::WHITE;
+
+        for (Square whitePawn = Square::A7; whitePawn <= Square::H2; whitePawn++) {
+            if (getFile(whitePawn) > File::_D) {
+                continue;
+            }
+
+            for (Square whiteKing = Square::A8; whiteKing <= Square::H1; whiteKing++) {
+                for (Square blackKing = Square::A8; blackKing <= Square::H1; blackKing++) {
+                    results[KpkIndex(whiteToMove, whiteKing, whitePawn, blackKing)] = ClassifyKpk(whiteToMove, whiteKing, whitePawn, blackKing);
+                }
+            }
+        }
+    }
+
+    //2) Work backward from the decided positions until nothing changes
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (std::uint32_t side = 0; side < Color::COLOR_COUNT; side++) {
+            bool whiteToMove = side == Color::WHITE;
+
+            for (Square whitePawn = Square::A7; whitePawn <= Square::H2; whitePawn++) {
+                if (getFile(whitePawn) > File::_D) {
+                    continue;
+                }
+
+                for (Square whiteKing = Square::A8; whiteKing <= Square::H1; whiteKing++) {
+                    for (Square blackKing = Square::A8; blackKing <= Square::H1; blackKing++) {
+                        KpkResult& result = results[KpkIndex(whiteToMove, whiteKing, whitePawn, blackKing)];
+
+                        if (result == KPK_UNKNOWN) {
+                            result = RetrogradeKpk(results, whiteToMove, whiteKing, whitePawn, blackKing);
+                            changed |= result != KPK_UNKNOWN;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //3) Anything still undecided can't be forced, so it is a draw.  Only the wins need a bit.
+    std::fill(std::begin(KpkBitbase), std::end(KpkBitbase), 0);
+
+    for (std::uint32_t index = 0; index < KpkPositionCount; index++) {
+        if (results[index] == KPK_WIN) {
+            KpkBitbase[index / 64] |= std::uint64_t(1) << (index % 64);
+        }
+    }
+
+    KpkBitbaseInitialized = true;
+}
+
+bool ProbeKpk(Square strongKing, Square strongPawn, Square weakKing, bool strongSideToMove)
+{
+    assert(KpkBitbaseInitialized);
+
+    //1) Mirror the pawn onto files A-D
+    if (getFile(strongPawn) > File::_D) {
+        strongKing = Square(strongKing ^ 7);
+        strongPawn = Square(strongPawn ^ 7);
+        weakKing = Square(weakKing ^ 7);
+    }
+
+    std::uint32_t index = KpkIndex(strongSideToMove, strongKing, strongPawn, weakKing);
+
+    return (KpkBitbase[index / 64] >> (index % 64)) & 1;
+}
+
+bool ProbeKpkBitbase(ChessBoard& board, Score& score)
+{
+    //1) Normalize so the pawn belongs to White
+    const Color strongSide = board.whitePieces[PieceType::PAWN] != EmptyBitboard ? Color::WHITE : Color::BLACK;
+
+    Square strongKing, strongPawn, weakKing;
+
+    if (strongSide == Color::WHITE) {
+        BitScanForward64((std::uint32_t*)&strongPawn, board.whitePieces[PieceType::PAWN]);
+        strongKing = board.whiteKingPosition;
+        weakKing = board.blackKingPosition;
+    }
+    else {
+        BitScanForward64((std::uint32_t*)&strongPawn, board.blackPieces[PieceType::PAWN]);
+        strongKing = FlipSqY(board.blackKingPosition);
+        strongPawn = FlipSqY(strongPawn);
+        weakKing = FlipSqY(board.whiteKingPosition);
+    }
+
+    //2) Wins are scored below any won KQK, pushing the pawn toward promotion.  Draws are exact.
+    if (ProbeKpk(strongKing, strongPawn, weakKing, board.sideToMove == strongSide)) {
+        score = BASICALLY_WINNING_SCORE + PAWN_SCORE * std::int32_t(Rank::_2 - getRank(strongPawn));
+    }
+    else {
+        score = DRAW_SCORE;
+    }
+
+    //3) Ensure score is returned for side to move
+    if (board.sideToMove != strongSide) {
+        score = -score;
+    }
+
+    return true;
+}
+
+bool ProbeBitbases(ChessBoard& board, Score& score)
+{
+    WdlResult result;
+
+    if (ProbeWdl(board, result)) {
+        score = GetWdlScore(board, result);
+
+        return true;
+    }
+
+    if (board.pieceCount == 3
+        && (board.pieceCounts[Color::WHITE][PieceType::PAWN] | board.pieceCounts[Color::BLACK][PieceType::PAWN]) != 0) {
+        return ProbeKpkBitbase(board, score);
+    }
+
+    return false;
+}
@@ -0,0 +1,38 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../../game/types/score.h"
+
+#include "../board/board.h"
+
+#include "../types/square.h"
+
+//The KPK bitbase holds one win/draw bit for every placement of the kings and the pawn, with the pawn's side normalized to
+//  White and the pawn mirrored onto files A-D.  2 sides to move * 24 pawn squares * 64 * 64 king squares = 24KB.
+static constexpr std::uint32_t KpkPawnSquareCount = 24;
+static constexpr std::uint32_t KpkPositionCount = Color::COLOR_COUNT * KpkPawnSquareCount * Square::SQUARE_COUNT * Square::SQUARE_COUNT;
+
+void InitializeKpkBitbase();
+
+bool ProbeKpk(Square strongKing, Square strongPawn, Square weakKing, bool strongSideToMove);
+bool ProbeKpkBitbase(ChessBoard& board, Score& score);
+
+//Probes the WDL bitbases loaded from disk, falling back on KPK, which is always available
+bool ProbeBitbases(ChessBoard& board, Score& score);
@@ -17,12 +17,9 @@
 */
 
 #include <cassert>
-#include <cmath>
-
-#include <map>
-
-#include "../hash/hash.h"
+#include <cstdint>
 
+#include "bitbase.h"
 #include "endgame.h"
 #include "function.h"
 
@@ -33,100 +30,111 @@
 #include "eval/krxkr.h"
 #include "eval/kxxk.h"
 
-static std::map<std::string, ChessEndgame::EndgameFunctionType> j = {
-    { "K7/8/8/8/8/8/8/7k w - - 0 1", kk },
-    { "k7/8/8/8/8/8/8/7K w - - 0 1", kk },
-
-    { "KN6/8/8/8/8/8/8/7k w - - 0 1", knk },
-    { "kn6/8/8/8/8/8/8/7K w - - 0 1", knk },
-    { "KB6/8/8/8/8/8/8/7k w - - 0 1", kbk },
-    { "kb6/8/8/8/8/8/8/7K w - - 0 1", kbk },
-    { "KR6/8/8/8/8/8/8/7k w - - 0 1", krk },
-    { "kr6/8/8/8/8/8/8/7K w - - 0 1", krk },
-    { "KQ6/8/8/8/8/8/8/7k w - - 0 1", kqk },
-    { "kq6/8/8/8/8/8/8/7K w - - 0 1", kqk },
-
-    { "KN6/8/8/8/8/8/8/6pk w - - 0 1", knkp },
-    { "kn6/8/8/8/8/8/8/6PK w - - 0 1", knkp },
-
-    { "KN6/8/8/8/8/8/8/6nk w - - 0 1", knkn },
-//    { "kn6/8/8/8/8/8/8/6NK w - - 0 1", knkn },
-
-    { "KB6/8/8/8/8/8/8/6pk w - - 0 1", kbkp },
-    { "kb6/8/8/8/8/8/8/6PK w - - 0 1", kbkp },
-    { "KB6/8/8/8/8/8/8/6nk w - - 0 1", kbkn },
-    { "kb6/8/8/8/8/8/8/6NK w - - 0 1", kbkn },
-    { "KB6/8/8/8/8/8/8/6bk w - - 0 1", kbkb },
-//    { "kb6/8/8/8/8/8/8/6BK w - - 0 1", kbkb },
-
-    { "KR6/8/8/8/8/8/8/6pk w - - 0 1", krkp },
-    { "kr6/8/8/8/8/8/8/6PK w - - 0 1", krkp },
-    { "KR6/8/8/8/8/8/8/6nk w - - 0 1", krkn },
-    { "kr6/8/8/8/8/8/8/6NK w - - 0 1", krkn },
-    { "KR6/8/8/8/8/8/8/6bk w - - 0 1", krkb },
-    { "kr6/8/8/8/8/8/8/6BK w - - 0 1", krkb },
-    { "KR6/8/8/8/8/8/8/6rk w - - 0 1", krkr },
-//    { "kr6/8/8/8/8/8/8/6RK w - - 0 1", krkr },
-
-    { "KRP5/8/8/8/8/8/8/7k w - - 0 1", krpk },
-    { "krp5/8/8/8/8/8/8/7K w - - 0 1", krpk },
-    { "KRN5/8/8/8/8/8/8/7k w - - 0 1", krnk },
-    { "krn5/8/8/8/8/8/8/7K w - - 0 1", krnk },
-    { "KRB5/8/8/8/8/8/8/7k w - - 0 1", krbk },
-    { "krb5/8/8/8/8/8/8/7K w - - 0 1", krbk },
-    { "KRR5/8/8/8/8/8/8/7k w - - 0 1", krrk },
-    { "krr5/8/8/8/8/8/8/7K w - - 0 1", krrk },
-
-    { "KQ6/8/8/8/8/8/8/6pk w - - 0 1", kqkp },
-    { "kq6/8/8/8/8/8/8/6PK w - - 0 1", kqkp },
-    { "KQ6/8/8/8/8/8/8/6nk w - - 0 1", kqkn },
-    { "kq6/8/8/8/8/8/8/6NK w - - 0 1", kqkn },
-    { "KQ6/8/8/8/8/8/8/6bk w - - 0 1", kqkb },
-    { "kq6/8/8/8/8/8/8/6BK w - - 0 1", kqkb },
-    { "KQ6/8/8/8/8/8/8/6rk w - - 0 1", kqkr },
-    { "kq6/8/8/8/8/8/8/6RK w - - 0 1", kqkr },
-    { "KQ6/8/8/8/8/8/8/6qk w - - 0 1", kqkq },
-//    { "kq6/8/8/8/8/8/8/6QK w - - 0 1", kqkq },
-
-    { "KQP5/8/8/8/8/8/8/7k w - - 0 1", kqpk },
-    { "kqp5/8/8/8/8/8/8/7K w - - 0 1", kqpk },
-    { "KQN5/8/8/8/8/8/8/7k w - - 0 1", kqnk },
-    { "kqn5/8/8/8/8/8/8/7K w - - 0 1", kqnk },
-    { "KQB5/8/8/8/8/8/8/7k w - - 0 1", kqbk },
-    { "kqb5/8/8/8/8/8/8/7K w - - 0 1", kqbk },
-    { "KQR5/8/8/8/8/8/8/7k w - - 0 1", kqrk },
-    { "kqr5/8/8/8/8/8/8/7K w - - 0 1", kqrk },
-    { "KQQ5/8/8/8/8/8/8/7k w - - 0 1", kqqk },
-    { "kqq5/8/8/8/8/8/8/7K w - - 0 1", kqqk },
-
-    { "KRP5/8/8/8/8/8/8/6rk w - - 0 1", krpkr },
-    { "krp5/8/8/8/8/8/8/6RK w - - 0 1", krpkr },
-    { "KRB5/8/8/8/8/8/8/6rk w - - 0 1", krnkb },
-    { "krb5/8/8/8/8/8/8/6RK w - - 0 1", krnkb },
-    { "KRN5/8/8/8/8/8/8/6rk w - - 0 1", krnkr },
-    { "krn5/8/8/8/8/8/8/6RK w - - 0 1", krnkr },
-    { "KRB5/8/8/8/8/8/8/6nk w - - 0 1", krbkn },
-    { "krb5/8/8/8/8/8/8/6NK w - - 0 1", krbkn },
-    { "KRB5/8/8/8/8/8/8/6bk w - - 0 1", krbkb },
-    { "krb5/8/8/8/8/8/8/6BK w - - 0 1", krbkb },
-    { "KRB5/8/8/8/8/8/8/6rk w - - 0 1", krbkr },
-    { "krb5/8/8/8/8/8/8/6RK w - - 0 1", krbkr },
-
-    { "KQP5/8/8/8/8/8/8/6qk w - - 0 1", kqpkq },
-    { "kqp5/8/8/8/8/8/8/6QK w - - 0 1", kqpkq },
-    { "KQN5/8/8/8/8/8/8/6qk w - - 0 1", kqnkq },
-    { "kqn5/8/8/8/8/8/8/6QK w - - 0 1", kqnkq },
+struct EndgameRegistration
+{
+    const char* whitePieces;
+    const char* blackPieces;
+    ChessEndgame::EndgameFunctionType function;
+};
+
+//Each registration covers both colours, so the functions have to work out the strong side for themselves
+static constexpr EndgameRegistration EndgameRegistrations[] = {
+    { "K", "K", kk },
+
+    { "KP", "K", kpk },
+    { "KN", "K", knk },
+    { "KB", "K", kbk },
+    { "KR", "K", krk },
+    { "KQ", "K", kqk },
+
+    { "KN", "KP", knkp },
+    { "KN", "KN", knkn },
+
+    { "KB", "KP", kbkp },
+    { "KB", "KN", kbkn },
+    { "KB", "KB", kbkb },
+
+    { "KR", "KP", krkp },
+    { "KR", "KN", krkn },
+    { "KR", "KB", krkb },
+    { "KR", "KR", krkr },
+
+    { "KRP", "K", krpk },
+    { "KRN", "K", krnk },
+    { "KRB", "K", krbk },
+    { "KRR", "K", krrk },
+
+    { "KQ", "KP", kqkp },
+    { "KQ", "KN", kqkn },
+    { "KQ", "KB", kqkb },
+    { "KQ", "KR", kqkr },
+    { "KQ", "KQ", kqkq },
+
+    { "KQP", "K", kqpk },
+    { "KQN", "K", kqnk },
+    { "KQB", "K", kqbk },
+    { "KQR", "K", kqrk },
+    { "KQQ", "K", kqqk },
+
+    { "KRP", "KR", krpkr },
+    { "KRN", "KB", krnkb },
+    { "KRN", "KR", krnkr },
+    { "KRB", "KN", krbkn },
+    { "KRB", "KB", krbkb },
+    { "KRB", "KR", krbkr },
+
+    { "KQP", "KQ", kqpkq },
+    { "KQN", "KQ", kqnkq },
+};
+
+static constexpr std::uint32_t GetEndgameSideCode(const char* pieces)
+{
+    std::uint32_t code = 0;
+
+    for (; *pieces != '\0'; pieces++) {
+        switch (*pieces) {
+        case 'P': code += 1 << 0; break;
+        case 'N': code += 1 << 2; break;
+        case 'B': code += 1 << 4; break;
+        case 'R': code += 1 << 6; break;
+        case 'Q': code += 1 << 8; break;
+        default: break;
+        }
+    }
+
+    return code;
+}
+
+struct EndgameTable
+{
+    ChessEndgame::EndgameFunctionType functions[EndgameMaterialCount];
 };
 
-void InitializeEndgame(ChessEndgame& endgame)
+static constexpr EndgameTable BuildEndgameTable()
 {
-    InitializeHashValues();
+    EndgameTable table = {};
 
-    ChessBoard board;
+    for (const EndgameRegistration& registration : EndgameRegistrations) {
+        std::uint32_t white = EndgameSideIndex.indices[GetEndgameSideCode(registration.whitePieces)];
+        std::uint32_t black = EndgameSideIndex.indices[GetEndgameSideCode(registration.blackPieces)];
 
-    std::map<std::string, ChessEndgame::EndgameFunctionType>::iterator it;
-    for (it = j.begin(); it != j.end(); ++it) {
-        board.initFromFen(it->first);
-        endgame.add(board, it->second);
+        table.functions[white * EndgameSideCount + black] = registration.function;
+        table.functions[black * EndgameSideCount + white] = registration.function;
     }
+
+    return table;
+}
+
+static constexpr EndgameTable Endgames = BuildEndgameTable();
+
+bool ChessEndgame::probe(ChessBoard& board, Score& score)
+{
+    EndgameFunctionType function = Endgames.functions[GetEndgameMaterialIndex(board)];
+
+    return function != nullptr && function(board, score);
+}
+
+void InitializeEndgame()
+{
+    InitializeKpkBitbase();
 }
@@ -18,12 +18,70 @@
 
 #pragma once
 
-#include "../../game/endgame/endgame.h"
+#include <cassert>
+#include <cstdint>
 
 #include "../../game/types/score.h"
 
 #include "../board/board.h"
 
-typedef Endgame<ChessBoard> ChessEndgame;
+#include "../types/piece.h"
 
-void InitializeEndgame(ChessEndgame& endgame);
+//Endgames are only probed with five pieces or fewer, so neither side has more than three besides its king.  Written
+//  as base 4 counts with pawns in the lowest digit, a side's pieces are one of 56 sets, each of which gets a dense index.
+static constexpr std::int32_t EndgameMaxPieces = 5;
+static constexpr std::uint32_t EndgameSideCodeCount = 1024;
+static constexpr std::uint32_t EndgameSideCount = 56;
+static constexpr std::uint32_t EndgameMaterialCount = EndgameSideCount * EndgameSideCount;
+
+struct EndgameSideIndices
+{
+    std::uint8_t indices[EndgameSideCodeCount];
+};
+
+static constexpr EndgameSideIndices BuildEndgameSideIndices()
+{
+    EndgameSideIndices sideIndices = {};
+    std::uint8_t sideIndex = 0;
+
+    for (std::uint32_t code = 0; code < EndgameSideCodeCount; code++) {
+        std::uint32_t pieceCount = (code & 3) + ((code >> 2) & 3) + ((code >> 4) & 3) + ((code >> 6) & 3) + ((code >> 8) & 3);
+
+        sideIndices.indices[code] = pieceCount <= 3 ? sideIndex++ : 0xff;
+    }
+
+    return sideIndices;
+}
+
+static constexpr EndgameSideIndices EndgameSideIndex = BuildEndgameSideIndices();
+
+static_assert(EndgameSideIndex.indices[EndgameSideCodeCount - 1] == 0xff && EndgameSideIndex.indices[3 << 8] == EndgameSideCount - 1, "Every side with up to three pieces needs an index");
+
+static std::uint32_t GetEndgameSideCode(const std::int32_t* pieceCounts)
+{
+    return pieceCounts[PieceType::PAWN]
+        | (pieceCounts[PieceType::KNIGHT] << 2)
+        | (pieceCounts[PieceType::BISHOP] << 4)
+        | (pieceCounts[PieceType::ROOK] << 6)
+        | (pieceCounts[PieceType::QUEEN] << 8);
+}
+
+static std::uint32_t GetEndgameMaterialIndex(ChessBoard& board)
+{
+    assert(board.pieceCount <= EndgameMaxPieces);
+
+    std::uint32_t white = EndgameSideIndex.indices[GetEndgameSideCode(board.pieceCounts[Color::WHITE])];
+    std::uint32_t black = EndgameSideIndex.indices[GetEndgameSideCode(board.pieceCounts[Color::BLACK])];
+
+    return white * EndgameSideCount + black;
+}
+
+class ChessEndgame
+{
+public:
+    typedef bool (*EndgameFunctionType)(ChessBoard& board, Score& score);
+
+    bool probe(ChessBoard& board, Score& score);
+};
+
+void InitializeEndgame();
@@ -20,4 +20,4 @@
 
 #include "../function.h"
 
-static ChessEndgame::EndgameFunctionType kk = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kk = drawEndgameFunction;
@@ -20,21 +20,21 @@
 
 #include "../function.h"
 
-static ChessEndgame::EndgameFunctionType kqpkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqpkq = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqnkq = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqbkq = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqrkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqnkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqbkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqrkq = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqqkn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqqkb = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqqkr = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqqkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqqkn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqqkb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqqkr = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqqkq = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqknn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqknn = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqkbn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkbb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkbn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkbb = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqkrn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkrb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkrn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkrb = weakKingEndgameFunction;
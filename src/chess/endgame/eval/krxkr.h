@@ -20,20 +20,20 @@
 
 #include "../function.h"
 
-static ChessEndgame::EndgameFunctionType krpkr = weakKingDrawishEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krpkr = weakKingDrawishEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType krnkn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krnkb = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krnkr = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krnkn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krnkb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krnkr = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType krbkn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krbkb = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krbkr = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krbkn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krbkb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krbkr = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType krrkn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krrkb = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krrkr = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krrkq = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krrkn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krrkb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krrkr = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krrkq = weakKingEndgameFunction;
 
 //static ChessEndgame::EndgameFunctionType krknn = weakKingEndgameFunction;
 
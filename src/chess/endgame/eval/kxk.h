@@ -18,10 +18,13 @@
 
 #pragma once
 
+#include "../bitbase.h"
 #include "../function.h"
 
-static ChessEndgame::EndgameFunctionType knk = drawEndgameFunction;
-static ChessEndgame::EndgameFunctionType kbk = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kpk = ProbeKpkBitbase;
 
-static ChessEndgame::EndgameFunctionType krk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType knk = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kbk = drawEndgameFunction;
+
+static constexpr ChessEndgame::EndgameFunctionType krk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqk = weakKingEndgameFunction;
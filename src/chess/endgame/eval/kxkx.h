@@ -25,7 +25,7 @@ static bool knkp(ChessBoard& board, Score& score)
     const Color strongSide = FindStrongSide(board);
 
     //2) Get pst values for KN and KP
-    Score pst = board.pstEvaluation.eg;
+    Score pst = GetEg(board.pstEvaluation);
 
     //psts are relative to white.  If strong side is Black, we have to negate.
     if (strongSide == Color::BLACK) {
@@ -47,19 +47,19 @@ static bool knkp(ChessBoard& board, Score& score)
     return true;
 }
 
-static ChessEndgame::EndgameFunctionType knkn = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType knkn = drawEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kbkp = knkp;
-static ChessEndgame::EndgameFunctionType kbkn = drawEndgameFunction;
-static ChessEndgame::EndgameFunctionType kbkb = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kbkp = knkp;
+static constexpr ChessEndgame::EndgameFunctionType kbkn = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kbkb = drawEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType krkp = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krkn = drawEndgameFunction;
-static ChessEndgame::EndgameFunctionType krkb = drawEndgameFunction;
-static ChessEndgame::EndgameFunctionType krkr = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krkp = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krkn = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krkb = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krkr = drawEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqkp = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkn = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkb = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkr = drawEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqkq = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkp = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkn = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkb = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkr = drawEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqkq = drawEndgameFunction;
@@ -20,13 +20,13 @@
 
 #include "../function.h"
 
-static ChessEndgame::EndgameFunctionType krpk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krnk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krbk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType krrk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krpk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krnk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krbk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType krrk = weakKingEndgameFunction;
 
-static ChessEndgame::EndgameFunctionType kqpk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqnk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqbk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqrk = weakKingEndgameFunction;
-static ChessEndgame::EndgameFunctionType kqqk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqpk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqnk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqbk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqrk = weakKingEndgameFunction;
+static constexpr ChessEndgame::EndgameFunctionType kqqk = weakKingEndgameFunction;
@@ -52,7 +52,7 @@ static bool drawEndgameFunction(ChessBoard& board, Score& score)
 static Color FindStrongSide(ChessBoard& board)
 {
     //There's no need to calculate the actual material value based on the phase calculated score
-    Score materialScore = board.materialEvaluation.eg;
+    Score materialScore = GetEg(board.materialEvaluation);
 
     if (materialScore == DRAW_SCORE) {
         return board.sideToMove;
@@ -83,7 +83,7 @@ static bool weakKingEndgameFunction(ChessBoard& board, Score& score)
     std::int32_t kingDistance = (std::int32_t)std::sqrt(file * file + rank * rank);
 
     //4) Account for other pieces being placed optimally
-    Score pst = board.pstEvaluation.eg;
+    Score pst = GetEg(board.pstEvaluation);
 
     //psts are relative to white.  If strong side is Black, we have to negate.
     if (strongSide == Color::BLACK) {
@@ -117,7 +117,7 @@ static bool weakKingDrawishEndgameFunction(ChessBoard& board, Score& score)
     std::int32_t kingDistance = (std::int32_t)std::sqrt(file * file + rank * rank);
 
     //4) Account for other pieces being places optimally
-    Score pst = board.pstEvaluation.eg;
+    Score pst = GetEg(board.pstEvaluation);
 
     //psts are relative to white.  If strong side is Black, we have to negate.
     if (strongSide == Color::BLACK) {
@@ -0,0 +1,442 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../game/math/bitscan.h"
+
+#include "../board/moves.h"
+
+#include "retrograde.h"
+#include "wdl.h"
+
+extern Bitboard WhitePawnCaptures[Square::SQUARE_COUNT];
+extern Bitboard BlackPawnCaptures[Square::SQUARE_COUNT];
+extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
+
+//The results share their values with WdlResult, so finished states are written out as they are
+enum RetrogradeState : std::uint8_t {
+    STATE_DRAW = WDL_DRAW,
+    STATE_WIN = WDL_WIN,
+    STATE_LOSS = WDL_LOSS,
+    STATE_UNKNOWN,
+    STATE_INVALID
+};
+
+static constexpr Bitboard WhitePromotionSquares = 0x00000000000000ffULL;
+static constexpr Bitboard BlackPromotionSquares = 0xff00000000000000ULL;
+
+static Bitboard GetPieceAttacks(PieceType piece, Color color, Square src, Bitboard occupied)
+{
+    switch (piece) {
+    case PieceType::PAWN:
+        return color == Color::WHITE ? WhitePawnCaptures[src] : BlackPawnCaptures[src];
+    case PieceType::BISHOP:
+        return BishopAttacks(src, occupied);
+    case PieceType::ROOK:
+        return RookAttacks(src, occupied);
+    case PieceType::QUEEN:
+        return BishopAttacks(src, occupied) | RookAttacks(src, occupied);
+    default:
+        return PieceMoves[piece][src];
+    }
+}
+
+static Bitboard GetOccupancy(const WdlPosition& position, Color color)
+{
+    Bitboard occupied = EmptyBitboard;
+
+    for (std::uint32_t slot = 0; slot < position.material.pieceCount; slot++) {
+        if (position.material.colors[slot] == color) {
+            occupied |= position.squares[slot];
+        }
+    }
+
+    return occupied;
+}
+
+static bool IsAttacked(const WdlPosition& position, Square dst, Color attacker)
+{
+    Bitboard occupied = GetOccupancy(position, Color::WHITE) | GetOccupancy(position, Color::BLACK);
+
+    for (std::uint32_t slot = 0; slot < position.material.pieceCount; slot++) {
+        if (position.material.colors[slot] == attacker
+            && (GetPieceAttacks(position.material.pieces[slot], attacker, position.squares[slot], occupied) & OneShiftedBy(dst)) != EmptyBitboard) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static Square GetKingPosition(const WdlPosition& position, Color color)
+{
+    return position.squares[color == Color::WHITE ? 0 : 1];
+}
+
+static bool IsValidPosition(const WdlPosition& position)
+{
+    //1) One piece per square
+    Bitboard occupied = EmptyBitboard;
+
+    for (std::uint32_t slot = 0; slot < position.material.pieceCount; slot++) {
+        if ((occupied & OneShiftedBy(position.squares[slot])) != EmptyBitboard) {
+            return false;
+        }
+
+        occupied |= position.squares[slot];
+    }
+
+    //2) The side that just moved can't be left in check
+    return !IsAttacked(position, GetKingPosition(position, ~position.sideToMove), position.sideToMove);
+}
+
+//Calls the visitor with every legal successor, and whether the successor still has the same material.  The visitor
+//  returns false to stop early.  A double push that an enemy pawn can capture en passant leaves a successor with its
+//  en passant square set, which isn't in any table.
+template <typename Visitor>
+static void VisitSuccessors(const WdlPosition& position, Visitor visit)
+{
+    const WdlMaterial& material = position.material;
+    const Color us = position.sideToMove;
+
+    const Bitboard ours = GetOccupancy(position, us);
+    const Bitboard theirs = GetOccupancy(position, ~us);
+    const Bitboard occupied = ours | theirs;
+
+    const Direction forward = us == Color::WHITE ? Direction::UP : Direction::DOWN;
+
+    for (std::uint32_t slot = 0; slot < material.pieceCount; slot++) {
+        if (material.colors[slot] != us) {
+            continue;
+        }
+
+        //1) Find the destinations
+        PieceType piece = material.pieces[slot];
+        Square src = position.squares[slot];
+        Bitboard dstSquares;
+
+        if (piece == PieceType::PAWN) {
+            Square push = src + forward;
+
+            dstSquares = GetPieceAttacks(piece, us, src, occupied) & theirs;
+
+            if (position.enPassant != Square::NO_SQUARE) {
+                dstSquares |= GetPieceAttacks(piece, us, src, occupied) & OneShiftedBy(position.enPassant);
+            }
+
+            if ((occupied & OneShiftedBy(push)) == EmptyBitboard) {
+                dstSquares |= push;
+
+                Square doublePush = push + forward;
+                Rank startRank = us == Color::WHITE ? Rank::_2 : Rank::_7;
+
+                if (getRank(src) == startRank && (occupied & OneShiftedBy(doublePush)) == EmptyBitboard) {
+                    dstSquares |= doublePush;
+                }
+            }
+        }
+        else {
+            dstSquares = GetPieceAttacks(piece, us, src, occupied) & ~ours;
+        }
+
+        Square dst;
+        while (BitScanForward64((std::uint32_t*)&dst, dstSquares)) {
+            dstSquares &= dstSquares - 1;
+
+            //2) Move the piece, taking off anything captured.  An en passant capture takes the pawn behind the destination.
+            WdlPosition successor = position;
+            successor.sideToMove = ~us;
+            successor.squares[slot] = dst;
+            successor.enPassant = Square::NO_SQUARE;
+
+            std::uint32_t movedSlot = slot;
+            bool sameMaterial = true;
+
+            Square capturedSquare = dst;
+
+            if (piece == PieceType::PAWN && dst == position.enPassant) {
+                capturedSquare = dst + forward * -1;
+            }
+
+            for (std::uint32_t captured = 2; captured < material.pieceCount; captured++) {
+                if (material.colors[captured] != us && position.squares[captured] == capturedSquare) {
+                    WdlMaterial& successorMaterial = successor.material;
+
+                    for (std::uint32_t next = captured + 1; next < successorMaterial.pieceCount; next++) {
+                        successorMaterial.pieces[next - 1] = successorMaterial.pieces[next];
+                        successorMaterial.colors[next - 1] = successorMaterial.colors[next];
+                        successor.squares[next - 1] = successor.squares[next];
+                    }
+
+                    successorMaterial.pieceCount--;
+                    movedSlot -= captured < slot ? 1 : 0;
+                    sameMaterial = false;
+                    break;
+                }
+            }
+
+            //3) Skip moves that leave the king in check
+            if (IsAttacked(successor, GetKingPosition(successor, us), ~us)) {
+                continue;
+            }
+
+            //4) Promotions leave the table, once per piece
+            Bitboard promotionSquares = us == Color::WHITE ? WhitePromotionSquares : BlackPromotionSquares;
+
+            if (piece == PieceType::PAWN && (promotionSquares & OneShiftedBy(dst)) != EmptyBitboard) {
+                for (PieceType promotion = PieceType::KNIGHT; promotion <= PieceType::QUEEN; promotion++) {
+                    successor.material.pieces[movedSlot] = promotion;
+
+                    if (!visit(successor, false)) {
+                        return;
+                    }
+                }
+
+                continue;
+            }
+
+            //5) A double push next to an enemy pawn allows an en passant capture
+            if (piece == PieceType::PAWN && dst == src + forward + forward) {
+                Square passed = src + forward;
+
+                for (std::uint32_t enemy = 2; enemy < material.pieceCount; enemy++) {
+                    if (material.colors[enemy] != us
+                        && material.pieces[enemy] == PieceType::PAWN
+                        && (GetPieceAttacks(PieceType::PAWN, us, passed, occupied) & OneShiftedBy(position.squares[enemy])) != EmptyBitboard) {
+                        successor.enPassant = passed;
+                    }
+                }
+            }
+
+            if (!visit(successor, sameMaterial)) {
+                return;
+            }
+        }
+    }
+}
+
+//A position is won if any move reaches a lost position, lost if every move reaches a won one, and drawn once every
+//  move is settled without either.  Anything else waits for a later pass.
+static RetrogradeState ResolvePosition(const WdlPosition& position, const std::atomic<std::uint8_t>* states, bool& missingTable)
+{
+    bool hasMove = false;
+    bool allWins = true;
+    bool allSettled = true;
+    bool lossFound = false;
+
+    VisitSuccessors(position, [&](const WdlPosition& successor, bool sameMaterial) {
+        RetrogradeState state;
+
+        //A successor with an en passant capture isn't in the table, so it's resolved here, a ply further on
+        if (successor.enPassant != Square::NO_SQUARE) {
+            state = ResolvePosition(successor, states, missingTable);
+        }
+        else if (sameMaterial) {
+            state = RetrogradeState(states[GetWdlIndex(successor)].load(std::memory_order_relaxed));
+        }
+        else if (successor.material.pieceCount == 2) {
+            state = STATE_DRAW;
+        }
+        else {
+            WdlResult result;
+
+            if (ProbeWdlPosition(successor, result)) {
+                state = RetrogradeState(result);
+            }
+            else {
+                missingTable = true;
+                state = STATE_DRAW;
+            }
+        }
+
+        assert(state != STATE_INVALID);
+
+        hasMove = true;
+        lossFound |= state == STATE_LOSS;
+        allWins &= state == STATE_WIN;
+        allSettled &= state != STATE_UNKNOWN;
+
+        return !lossFound;
+    });
+
+    if (lossFound) {
+        return STATE_WIN;
+    }
+
+    if (!hasMove) {
+        return IsAttacked(position, GetKingPosition(position, position.sideToMove), ~position.sideToMove) ? STATE_LOSS : STATE_DRAW;
+    }
+
+    if (allWins) {
+        return STATE_LOSS;
+    }
+
+    return allSettled ? STATE_DRAW : STATE_UNKNOWN;
+}
+
+template <typename Function>
+static void RunInParallel(std::uint64_t positionCount, std::uint32_t threadCount, Function function)
+{
+    std::vector<std::thread> threads;
+
+    for (std::uint32_t thread = 0; thread < threadCount; thread++) {
+        std::uint64_t begin = positionCount * thread / threadCount;
+        std::uint64_t end = positionCount * (thread + 1) / threadCount;
+
+        threads.emplace_back([=]() {
+            for (std::uint64_t index = begin; index < end; index++) {
+                function(index);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+static bool GenerateWdlTable(const std::string& directory, const WdlMaterial& material, std::uint32_t threadCount)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    const std::uint64_t positionCount = GetWdlPositionCount(material);
+    std::unique_ptr<std::atomic<std::uint8_t>[]> states(new std::atomic<std::uint8_t>[positionCount]);
+
+    //1) Mark the positions that can't occur
+    RunInParallel(positionCount, threadCount, [&](std::uint64_t index) {
+        WdlPosition position;
+        DecodeWdlIndex(material, index, position);
+
+        states[index].store(IsValidPosition(position) ? STATE_UNKNOWN : STATE_INVALID, std::memory_order_relaxed);
+    });
+
+    //2) Settle positions until a pass changes nothing.  The first pass finds the mates, stalemates and everything
+    //  decided by captures and promotions into the smaller tables.
+    std::atomic<bool> changed(true);
+    std::atomic<bool> missingTable(false);
+    std::uint32_t passCount = 0;
+
+    while (changed) {
+        changed = false;
+        passCount++;
+
+        RunInParallel(positionCount, threadCount, [&](std::uint64_t index) {
+            if (states[index].load(std::memory_order_relaxed) != STATE_UNKNOWN) {
+                return;
+            }
+
+            WdlPosition position;
+            DecodeWdlIndex(material, index, position);
+
+            bool missing = false;
+            RetrogradeState state = ResolvePosition(position, states.get(), missing);
+
+            if (missing) {
+                missingTable = true;
+            }
+
+            if (state != STATE_UNKNOWN) {
+                states[index].store(state, std::memory_order_relaxed);
+                changed = true;
+            }
+        });
+
+        if (missingTable) {
+            std::cout << "Error (missing bitbase below " << GetWdlName(material) << ")" << std::endl;
+
+            return false;
+        }
+    }
+
+    //3) Nobody can force anything from what's left, so it's drawn.  Pack four results to a byte.
+    std::vector<std::uint8_t> packed((positionCount + 3) / 4, 0);
+    std::uint64_t counts[STATE_INVALID + 1] = { 0 };
+
+    for (std::uint64_t index = 0; index < positionCount; index++) {
+        std::uint8_t state = states[index].load(std::memory_order_relaxed);
+        counts[state]++;
+
+        if (state == STATE_WIN || state == STATE_LOSS) {
+            packed[index / 4] |= state << (2 * (index % 4));
+        }
+    }
+
+    //4) Write the table and load it for the tables that follow
+    std::string fileName = directory + "/" + GetWdlName(material) + ".wdl";
+    std::ofstream file(fileName, std::ios::binary);
+
+    if (!file.is_open()) {
+        std::cout << "Error (cannot write bitbase): " << fileName << std::endl;
+
+        return false;
+    }
+
+    WdlFileHeader header = { { 'J', 'W', 'W', 'D' }, WdlFileVersion, positionCount };
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)packed.data(), packed.size());
+    file.close();
+
+    if (!LoadWdlTable(directory, material)) {
+        std::cout << "Error (cannot load bitbase): " << fileName << std::endl;
+
+        return false;
+    }
+
+    std::chrono::milliseconds time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << GetWdlName(material) << ": " << counts[STATE_WIN] << " wins " << counts[STATE_DRAW] + counts[STATE_UNKNOWN] << " draws "
+        << counts[STATE_LOSS] << " losses " << counts[STATE_INVALID] << " invalid, "
+        << passCount << " passes, " << time.count() << "ms" << std::endl;
+
+    return true;
+}
+
+bool GenerateBitbases(const std::string& directory, std::uint32_t threadCount)
+{
+    //1) The attack tables are normally set up by the move generator
+    SetupInBetweenBoard();
+    SetupSliderRays();
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    //2) Tables already loaded might be stale, so each one is replaced as it is rebuilt
+    UnloadBitbases();
+
+    std::vector<WdlMaterial> materials;
+    EnumerateWdlMaterials(materials);
+
+    for (const WdlMaterial& material : materials) {
+        if (!GenerateWdlTable(directory, material, threadCount)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,433 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../game/math/bitscan.h"
+
+#include "function.h"
+#include "wdl.h"
+
+struct WdlTable
+{
+    const std::uint8_t* data;
+    std::uint64_t positionCount;
+
+    void* mapping;
+    std::uint64_t mappingSize;
+};
+
+//Indexed by GetWdlMaterialIndex.  Only the stronger side's order of a signature is ever loaded.
+static WdlTable WdlTables[EndgameMaterialCount];
+static std::uint32_t WdlTableCount = 0;
+
+static WdlMaterial MakeWdlMaterial(std::vector<PieceType> whitePieces, std::vector<PieceType> blackPieces)
+{
+    WdlMaterial material = { 2, { PieceType::KING, PieceType::KING }, { Color::WHITE, Color::BLACK } };
+
+    std::sort(whitePieces.begin(), whitePieces.end(), std::greater<PieceType>());
+    std::sort(blackPieces.begin(), blackPieces.end(), std::greater<PieceType>());
+
+    for (PieceType piece : whitePieces) {
+        material.pieces[material.pieceCount] = piece;
+        material.colors[material.pieceCount++] = Color::WHITE;
+    }
+
+    for (PieceType piece : blackPieces) {
+        material.pieces[material.pieceCount] = piece;
+        material.colors[material.pieceCount++] = Color::BLACK;
+    }
+
+    return material;
+}
+
+//White has to be the stronger side: more pieces, or the same number with the better pieces.  The generator works from
+//  piece lists; probes from the board use IsCanonicalWdlPieceCounts.
+static bool IsCanonicalWdlMaterial(std::vector<PieceType> whitePieces, std::vector<PieceType> blackPieces)
+{
+    if (whitePieces.size() != blackPieces.size()) {
+        return whitePieces.size() > blackPieces.size();
+    }
+
+    std::sort(whitePieces.begin(), whitePieces.end(), std::greater<PieceType>());
+    std::sort(blackPieces.begin(), blackPieces.end(), std::greater<PieceType>());
+
+    return whitePieces >= blackPieces;
+}
+
+//The same order from piece counts: the better pieces are the ones with the higher count at the first piece type, from
+//  the queen down, where the sides differ
+static bool IsCanonicalWdlPieceCounts(const std::int32_t* whitePieceCounts, const std::int32_t* blackPieceCounts)
+{
+    if (whitePieceCounts[PieceType::ALL] != blackPieceCounts[PieceType::ALL]) {
+        return whitePieceCounts[PieceType::ALL] > blackPieceCounts[PieceType::ALL];
+    }
+
+    for (PieceType piece = PieceType::QUEEN; piece >= PieceType::PAWN; piece = PieceType(piece - 1)) {
+        if (whitePieceCounts[piece] != blackPieceCounts[piece]) {
+            return whitePieceCounts[piece] > blackPieceCounts[piece];
+        }
+    }
+
+    return true;
+}
+
+static WdlResult ReadWdlTable(const WdlTable& table, const WdlPosition& position)
+{
+    std::uint64_t index = GetWdlIndex(position);
+
+    assert(index < table.positionCount);
+
+    return WdlResult((table.data[index / 4] >> (2 * (index % 4))) & 3);
+}
+
+static std::uint32_t CountWdlPawns(const WdlMaterial& material)
+{
+    return std::uint32_t(std::count(material.pieces, material.pieces + material.pieceCount, PieceType::PAWN));
+}
+
+void EnumerateWdlMaterials(std::vector<WdlMaterial>& materials)
+{
+    materials.clear();
+
+    //1) Every split of one or two pieces between the sides, stronger side first
+    for (PieceType first = PieceType::PAWN; first <= PieceType::QUEEN; first++) {
+        materials.push_back(MakeWdlMaterial({ first }, {}));
+
+        for (PieceType second = PieceType::PAWN; second <= first; second++) {
+            materials.push_back(MakeWdlMaterial({ first, second }, {}));
+            materials.push_back(MakeWdlMaterial({ first }, { second }));
+        }
+    }
+
+    //2) Captures lead to fewer pieces and promotions to fewer pawns, so those tables have to come first
+    std::stable_sort(materials.begin(), materials.end(), [](const WdlMaterial& m1, const WdlMaterial& m2) {
+        if (m1.pieceCount != m2.pieceCount) {
+            return m1.pieceCount < m2.pieceCount;
+        }
+
+        return CountWdlPawns(m1) < CountWdlPawns(m2);
+    });
+}
+
+static const std::uint8_t* MapWdlFile(const std::string& fileName, void*& mapping, std::uint64_t& mappingSize)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+
+    if (fileMapping == nullptr) {
+        return nullptr;
+    }
+
+    void* data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+        CloseHandle(fileMapping);
+
+        return nullptr;
+    }
+
+    mapping = fileMapping;
+    mappingSize = std::uint64_t(fileSize.QuadPart);
+#else
+    int file = open(fileName.c_str(), O_RDONLY);
+
+    if (file == -1) {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    fstat(file, &fileStat);
+
+    void* data = fileStat.st_size > 0 ? mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+    close(file);
+
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    mapping = data;
+    mappingSize = std::uint64_t(fileStat.st_size);
+#endif
+
+    return (const std::uint8_t*)data;
+}
+
+static void UnmapWdlFile(const std::uint8_t* data, void* mapping, std::uint64_t mappingSize)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(mapping, mappingSize);
+#endif
+}
+
+bool LoadWdlTable(const std::string& directory, const WdlMaterial& material)
+{
+    //1) Map the file, replacing any table already loaded for the signature
+    std::string fileName = directory + "/" + GetWdlName(material) + ".wdl";
+    WdlTable& loadedTable = WdlTables[GetWdlMaterialIndex(material)];
+
+    WdlTable table;
+    const std::uint8_t* data = MapWdlFile(fileName, table.mapping, table.mappingSize);
+
+    if (data == nullptr) {
+        return false;
+    }
+
+    //2) Check the header against the signature the name promises
+    WdlFileHeader header;
+    table.positionCount = GetWdlPositionCount(material);
+
+    if (table.mappingSize < sizeof(header)) {
+        UnmapWdlFile(data, table.mapping, table.mappingSize);
+
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, "JWWD", 4) != 0
+        || header.version != WdlFileVersion
+        || header.positionCount != table.positionCount
+        || table.mappingSize != sizeof(header) + (table.positionCount + 3) / 4) {
+        UnmapWdlFile(data, table.mapping, table.mappingSize);
+
+        return false;
+    }
+
+    table.data = data + sizeof(header);
+
+    if (loadedTable.data != nullptr) {
+        UnmapWdlFile(loadedTable.data - sizeof(WdlFileHeader), loadedTable.mapping, loadedTable.mappingSize);
+    }
+    else {
+        WdlTableCount++;
+    }
+
+    loadedTable = table;
+
+    return true;
+}
+
+bool LoadBitbases(const std::string& directory)
+{
+    UnloadBitbases();
+
+    std::vector<WdlMaterial> materials;
+    EnumerateWdlMaterials(materials);
+
+    for (const WdlMaterial& material : materials) {
+        LoadWdlTable(directory, material);
+    }
+
+    return WdlTableCount > 0;
+}
+
+void UnloadBitbases()
+{
+    for (WdlTable& table : WdlTables) {
+        if (table.data != nullptr) {
+            UnmapWdlFile(table.data - sizeof(WdlFileHeader), table.mapping, table.mappingSize);
+
+            table = WdlTable();
+        }
+    }
+
+    WdlTableCount = 0;
+}
+
+//Probes a position the generator built.  Searches go through ProbeWdl, which works from the board without allocating.
+bool ProbeWdlPosition(const WdlPosition& position, WdlResult& result)
+{
+    const WdlMaterial& material = position.material;
+
+    assert(position.enPassant == Square::NO_SQUARE);
+
+    //1) Split the pieces by colour, and let the stronger side play White
+    std::vector<PieceType> pieces[Color::COLOR_COUNT];
+
+    for (std::uint32_t slot = 0; slot < material.pieceCount; slot++) {
+        if (material.pieces[slot] != PieceType::KING) {
+            pieces[material.colors[slot]].push_back(material.pieces[slot]);
+        }
+    }
+
+    const bool flip = !IsCanonicalWdlMaterial(pieces[Color::WHITE], pieces[Color::BLACK]);
+
+    //2) Lay the position out like its table
+    WdlPosition arranged;
+    arranged.material = flip ? MakeWdlMaterial(pieces[Color::BLACK], pieces[Color::WHITE]) : MakeWdlMaterial(pieces[Color::WHITE], pieces[Color::BLACK]);
+    arranged.sideToMove = flip ? ~position.sideToMove : position.sideToMove;
+    arranged.enPassant = Square::NO_SQUARE;
+
+    const WdlTable& table = WdlTables[GetWdlMaterialIndex(arranged.material)];
+    if (table.data == nullptr) {
+        return false;
+    }
+
+    bool used[WdlMaxPieces] = { false };
+
+    for (std::uint32_t slot = 0; slot < arranged.material.pieceCount; slot++) {
+        for (std::uint32_t src = 0; src < material.pieceCount; src++) {
+            Color color = flip ? ~material.colors[src] : material.colors[src];
+
+            if (!used[src] && material.pieces[src] == arranged.material.pieces[slot] && color == arranged.material.colors[slot]) {
+                arranged.squares[slot] = flip ? FlipSqY(position.squares[src]) : position.squares[src];
+                used[src] = true;
+                break;
+            }
+        }
+    }
+
+    //3) Read the two bits
+    result = ReadWdlTable(table, arranged);
+
+    return true;
+}
+
+bool ProbeWdl(ChessBoard& board, WdlResult& result)
+{
+    if (WdlTableCount == 0 || board.pieceCount > std::int32_t(WdlMaxPieces)) {
+        return false;
+    }
+
+    //1) The tables only hold positions without castling rights or an en passant capture
+    if (board.castleRights != CastleRights::CASTLE_NONE
+        || board.enPassant != Square::NO_SQUARE) {
+        return false;
+    }
+
+    //2) Let the stronger side play White, and find its table
+    const bool flip = !IsCanonicalWdlPieceCounts(board.pieceCounts[Color::WHITE], board.pieceCounts[Color::BLACK]);
+    const Color strongSide = flip ? Color::BLACK : Color::WHITE;
+
+    const WdlTable& table = WdlTables[GetWdlMaterialIndex(board.pieceCounts[strongSide], board.pieceCounts[~strongSide])];
+    if (table.data == nullptr) {
+        return false;
+    }
+
+    //3) Lay the position out like its table: the kings, then each side's pieces from the queen down
+    WdlPosition position;
+    position.sideToMove = flip ? ~board.sideToMove : board.sideToMove;
+    position.enPassant = Square::NO_SQUARE;
+
+    WdlMaterial& material = position.material;
+    material.pieceCount = 2;
+
+    for (Color side = Color::WHITE; side < Color::COLOR_COUNT; side = Color(side + 1)) {
+        const Color color = flip ? ~side : side;
+        const Square king = color == Color::WHITE ? board.whiteKingPosition : board.blackKingPosition;
+
+        material.pieces[side] = PieceType::KING;
+        material.colors[side] = side;
+        position.squares[side] = flip ? FlipSqY(king) : king;
+    }
+
+    for (Color side = Color::WHITE; side < Color::COLOR_COUNT; side = Color(side + 1)) {
+        Bitboard* pieces = (flip ? ~side : side) == Color::WHITE ? board.whitePieces : board.blackPieces;
+
+        for (PieceType piece = PieceType::QUEEN; piece >= PieceType::PAWN; piece = PieceType(piece - 1)) {
+            Bitboard remaining = pieces[piece];
+            Square src;
+
+            while (BitScanForward64((std::uint32_t*)&src, remaining)) {
+                remaining &= remaining - 1;
+
+                material.pieces[material.pieceCount] = piece;
+                material.colors[material.pieceCount] = side;
+                position.squares[material.pieceCount++] = flip ? FlipSqY(src) : src;
+            }
+        }
+    }
+
+    //4) Read the two bits
+    result = ReadWdlTable(table, position);
+
+    return true;
+}
+
+Score GetWdlScore(ChessBoard& board, WdlResult result)
+{
+    if (result == WDL_DRAW) {
+        return DRAW_SCORE;
+    }
+
+    //1) Start from the winner's material, so captures and promotions still look like progress
+    const Color winner = result == WDL_WIN ? board.sideToMove : ~board.sideToMove;
+
+    Score material = GetEg(board.materialEvaluation);
+    if (winner == Color::BLACK) {
+        material = -material;
+    }
+
+    Score score = BASICALLY_WINNING_SCORE + material;
+
+    //2) Push the winner's pawns, or without any, drive the losing king to the edge with the winning king close by
+    Bitboard pawns = winner == Color::WHITE ? board.whitePieces[PieceType::PAWN] : board.blackPieces[PieceType::PAWN];
+
+    if (pawns != EmptyBitboard) {
+        Square src;
+
+        while (BitScanForward64((std::uint32_t*)&src, pawns)) {
+            pawns &= pawns - 1;
+
+            std::int32_t advance = winner == Color::WHITE ? Rank::_2 - getRank(src) : getRank(src) - Rank::_7;
+            score += PAWN_SCORE * advance;
+        }
+    }
+    else {
+        Square loserKing = winner == Color::WHITE ? board.blackKingPosition : board.whiteKingPosition;
+
+        File file = getFile(board.whiteKingPosition) - getFile(board.blackKingPosition);
+        Rank rank = getRank(board.whiteKingPosition) - getRank(board.blackKingPosition);
+
+        std::int32_t kingDistance = (std::int32_t)std::sqrt(file * file + rank * rank);
+
+        score += GeneralMate[loserKing] + Proximity[kingDistance];
+    }
+
+    //3) Ensure score is returned for side to move
+    return result == WDL_WIN ? score : -score;
+}
@@ -0,0 +1,203 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../../game/types/color.h"
+#include "../../game/types/score.h"
+
+#include "../board/board.h"
+
+#include "../types/piece.h"
+#include "../types/square.h"
+
+#include "endgame.h"
+
+//WDL bitbases hold a win, draw or loss for the side to move in every position of a material signature, two bits each.
+//  Only one colour order of each signature is stored: the stronger side plays White.  Pawnless tables put the white
+//  king on the a1-d4 quadrant, tables with pawns only mirror the white king onto files A-D.  Stored positions have no
+//  en passant capture available.
+static constexpr std::uint32_t WdlMaxPieces = 4;
+static constexpr std::uint32_t WdlFileVersion = 2;
+
+static_assert(WdlMaxPieces <= EndgameMaxPieces, "WDL signatures share the endgame material index");
+
+enum WdlResult : std::uint8_t {
+    WDL_DRAW, WDL_WIN, WDL_LOSS
+};
+
+//Slot 0 is the white king, slot 1 the black king, then White's pieces and Black's pieces, each from the queen down
+struct WdlMaterial
+{
+    std::uint32_t pieceCount;
+    PieceType pieces[WdlMaxPieces];
+    Color colors[WdlMaxPieces];
+};
+
+struct WdlPosition
+{
+    WdlMaterial material;
+    Square squares[WdlMaxPieces];
+    Color sideToMove;
+    Square enPassant;       //Only set while an enemy pawn can capture the pawn that just moved two squares
+};
+
+struct WdlFileHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t positionCount;
+};
+
+static bool HasWdlPawns(const WdlMaterial& material)
+{
+    for (std::uint32_t slot = 2; slot < material.pieceCount; slot++) {
+        if (material.pieces[slot] == PieceType::PAWN) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Tables are found by the same dense material index as the endgame functions, with White's pieces first
+static std::uint32_t GetWdlMaterialIndex(const std::int32_t* whitePieceCounts, const std::int32_t* blackPieceCounts)
+{
+    std::uint32_t white = EndgameSideIndex.indices[GetEndgameSideCode(whitePieceCounts)];
+    std::uint32_t black = EndgameSideIndex.indices[GetEndgameSideCode(blackPieceCounts)];
+
+    return white * EndgameSideCount + black;
+}
+
+static std::uint32_t GetWdlMaterialIndex(const WdlMaterial& material)
+{
+    std::int32_t pieceCounts[Color::COLOR_COUNT][PieceType::PIECETYPE_COUNT] = {};
+
+    for (std::uint32_t slot = 2; slot < material.pieceCount; slot++) {
+        pieceCounts[material.colors[slot]][material.pieces[slot]]++;
+    }
+
+    return GetWdlMaterialIndex(pieceCounts[Color::WHITE], pieceCounts[Color::BLACK]);
+}
+
+static std::uint64_t GetWdlPositionCount(const WdlMaterial& material)
+{
+    std::uint64_t positionCount = Color::COLOR_COUNT * (HasWdlPawns(material) ? 32 : 16) * Square::SQUARE_COUNT;
+
+    for (std::uint32_t slot = 2; slot < material.pieceCount; slot++) {
+        positionCount *= material.pieces[slot] == PieceType::PAWN ? 48 : 64;
+    }
+
+    return positionCount;
+}
+
+//The position has to be laid out like its table already.  Mirroring onto the white king's quadrant happens here.
+static std::uint64_t GetWdlIndex(const WdlPosition& position)
+{
+    const WdlMaterial& material = position.material;
+    const bool hasPawns = HasWdlPawns(material);
+
+    //1) Mirror the white king onto files A-D, and without pawns onto ranks 1-4 as well
+    std::uint32_t mirror = getFile(position.squares[0]) > File::_D ? 7 : 0;
+
+    if (!hasPawns && std::int32_t(getRank(position.squares[0])) < std::int32_t(Rank::_4)) {
+        mirror ^= 56;
+    }
+
+    //2) Combine the squares, most significant first
+    Square whiteKing = Square(position.squares[0] ^ mirror);
+    std::uint64_t index = position.sideToMove == Color::WHITE ? 0 : 1;
+
+    if (hasPawns) {
+        index = index * 32 + getRank(whiteKing) * 4 + getFile(whiteKing);
+    }
+    else {
+        index = index * 16 + (getRank(whiteKing) - Rank::_4) * 4 + getFile(whiteKing);
+    }
+
+    for (std::uint32_t slot = 1; slot < material.pieceCount; slot++) {
+        Square src = Square(position.squares[slot] ^ mirror);
+
+        if (material.pieces[slot] == PieceType::PAWN) {
+            index = index * 48 + (src - Square::A7);
+        }
+        else {
+            index = index * 64 + src;
+        }
+    }
+
+    return index;
+}
+
+static void DecodeWdlIndex(const WdlMaterial& material, std::uint64_t index, WdlPosition& position)
+{
+    position.material = material;
+
+    for (std::uint32_t slot = material.pieceCount - 1; slot > 0; slot--) {
+        if (material.pieces[slot] == PieceType::PAWN) {
+            position.squares[slot] = Square(Square::A7 + index % 48);
+            index /= 48;
+        }
+        else {
+            position.squares[slot] = Square(index % 64);
+            index /= 64;
+        }
+    }
+
+    std::uint32_t kingIndex;
+
+    if (HasWdlPawns(material)) {
+        kingIndex = std::uint32_t(index % 32);
+        index /= 32;
+    }
+    else {
+        kingIndex = std::uint32_t(index % 16) + 16;
+        index /= 16;
+    }
+
+    position.squares[0] = Square((kingIndex / 4) * 8 + kingIndex % 4);
+    position.sideToMove = index == 0 ? Color::WHITE : Color::BLACK;
+    position.enPassant = Square::NO_SQUARE;
+}
+
+static std::string GetWdlName(const WdlMaterial& material)
+{
+    static const char PieceNames[] = " PNBRQK";
+
+    std::string name[Color::COLOR_COUNT] = { "K", "K" };
+
+    for (std::uint32_t slot = 2; slot < material.pieceCount; slot++) {
+        name[material.colors[slot]] += PieceNames[material.pieces[slot]];
+    }
+
+    return name[Color::WHITE] + "v" + name[Color::BLACK];
+}
+
+void EnumerateWdlMaterials(std::vector<WdlMaterial>& materials);
+
+bool LoadBitbases(const std::string& directory);
+bool LoadWdlTable(const std::string& directory, const WdlMaterial& material);
+void UnloadBitbases();
+
+bool ProbeWdlPosition(const WdlPosition& position, WdlResult& result);
+bool ProbeWdl(ChessBoard& board, WdlResult& result);
+Score GetWdlScore(ChessBoard& board, WdlResult result);
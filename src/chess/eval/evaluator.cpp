@@ -17,9 +17,27 @@
 */
 
 #include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#ifdef USE_M128I
+#include <nmmintrin.h>
+#endif
+
+#ifdef USE_EVALUATION_PROFILE
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
 
 #include "evaluator.h"
+#include "parameters.h"
+#include "pieceattacks.h"
 
+#include "../endgame/bitbase.h"
 #include "../endgame/function.h"
 
 #include "../types/bitboard.h"
@@ -27,6 +45,7 @@
 
 #include "../../game/math/bitreset.h"
 #include "../../game/math/bitscan.h"
+#include "../../game/math/byteswap.h"
 #include "../../game/math/popcount.h"
 
 extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
@@ -38,26 +57,36 @@ extern Bitboard WhitePawnCaptures[Square::SQUARE_COUNT];
 
 extern Bitboard bbFile[File::FILE_COUNT];
 
-extern Evaluation AttackParameters[PieceType::PIECETYPE_COUNT][PieceType::PIECETYPE_COUNT]; 
-extern Evaluation DoubledRooks;
-extern Evaluation EmptyFileQueen;
-extern Evaluation EmptyFileRook;
-extern Evaluation GoodBishopPawns[8];
-extern Evaluation BetterMobilityParameters[PieceType::PIECETYPE_COUNT][32];
-extern Evaluation BoardControlPstParameters[Square::SQUARE_COUNT];
-extern Evaluation KingControlPstParameters[Square::SQUARE_COUNT];
-extern Evaluation MobilityParameters[PieceType::PIECETYPE_COUNT][32];
-extern Evaluation PiecePairs[PieceType::PIECETYPE_COUNT];
-extern Evaluation QueenBehindPassedPawnPst[Square::SQUARE_COUNT];
-extern Evaluation RookBehindPassedPawnPst[Square::SQUARE_COUNT];
-extern Evaluation SafeMobilityParameters[PieceType::PIECETYPE_COUNT][32];
-extern Evaluation TropismParameters[PieceType::PIECETYPE_COUNT][16];
-
 extern std::uint32_t Distance[File::FILE_COUNT][Rank::RANK_COUNT];
 
+//The smallest margin allowed for each stage.  Together they make up the old four pawn lazy evaluation threshold.
+static constexpr Score StageMarginFloors[EvaluationStage::EVALUATIONSTAGE_COUNT] = {
+    Score(1 * PAWN_SCORE), Score(2 * PAWN_SCORE), Score(1 * PAWN_SCORE)
+};
+
 ChessEvaluator::ChessEvaluator()
 {
-    InitializeEndgame(this->endgame);
+    InitializeEndgame();
+
+    this->evaluationCount = 0;
+
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        this->skippedStages[stage] = 0;
+    }
+
+    this->resetStageMargins();
+
+#ifdef USE_EVALUATION_PROFILE
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        this->stageCycles[stage] = 0;
+        this->stageCalls[stage] = 0;
+    }
+
+    for (EvaluationTerm term = EvaluationTerm::ATTACK_MAP_TERM; term < EvaluationTerm::EVALUATIONTERM_COUNT; term++) {
+        this->termCycles[term] = 0;
+        this->termCalls[term] = 0;
+    }
+#endif
 }
 
 ChessEvaluator::~ChessEvaluator()
@@ -65,11 +94,69 @@ ChessEvaluator::~ChessEvaluator()
 
 }
 
-bool ChessEvaluator::checkBoardForInsufficientMaterial(BoardType& board)
+bool ChessEvaluator::canSkipStages(EvaluationStage stage, Score score, Score alpha, Score beta)
+{
+    Score margin = ZERO_SCORE;
+
+    for (EvaluationStage remainingStage = stage; remainingStage < EvaluationStage::EVALUATIONSTAGE_COUNT; remainingStage++) {
+        margin += this->stageMargins[remainingStage];
+    }
+
+    if (score + margin < alpha
+        || score - margin >= beta) {
+        this->skippedStages[stage]++;
+        return true;
+    }
+
+    return false;
+}
+
+//Without USE_EVALUATION_PROFILE these are empty and compile away
+std::uint64_t ChessEvaluator::startProfile()
 {
-    std::uint32_t pieceCount = popCount(board.allPieces);
+#ifdef USE_EVALUATION_PROFILE
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+void ChessEvaluator::stopProfile(EvaluationStage stage, std::uint64_t start)
+{
+#ifdef USE_EVALUATION_PROFILE
+    this->stageCycles[stage] += __rdtsc() - start;
+    this->stageCalls[stage]++;
+#endif
+}
+
+void ChessEvaluator::stopProfile(EvaluationTerm term, std::uint64_t start)
+{
+#ifdef USE_EVALUATION_PROFILE
+    this->termCycles[term] += __rdtsc() - start;
+    this->termCalls[term]++;
+#endif
+}
 
-    switch (pieceCount) {
+//The margins only grow as stages are measured, so they start over from the floors for a new game or personality
+void ChessEvaluator::resetStageMargins()
+{
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        this->stageMargins[stage] = StageMarginFloors[stage];
+    }
+}
+
+void ChessEvaluator::measureStage(EvaluationStage stage, Score contribution)
+{
+    contribution = contribution < ZERO_SCORE ? -contribution : contribution;
+
+    if (contribution > this->stageMargins[stage]) {
+        this->stageMargins[stage] = contribution;
+    }
+}
+
+bool ChessEvaluator::checkBoardForInsufficientMaterial(BoardType& board)
+{
+    switch (board.pieceCount) {
     case 2:
         return true;
     case 3:
@@ -78,15 +165,15 @@ bool ChessEvaluator::checkBoardForInsufficientMaterial(BoardType& board)
         }
         break;
     case 4:
-        if (popCount(board.whitePieces[PieceType::KNIGHT]) == 2) {
+        if (board.pieceCounts[Color::WHITE][PieceType::KNIGHT] == 2) {
             return true;
         }
 
-        if (popCount(board.blackPieces[PieceType::KNIGHT]) == 2) {
+        if (board.pieceCounts[Color::BLACK][PieceType::KNIGHT] == 2) {
             return true;
         }
 
-        if (popCountIsOne(board.whitePieces[PieceType::BISHOP]) && popCountIsOne(board.blackPieces[PieceType::BISHOP])) {
+        if (board.pieceCounts[Color::WHITE][PieceType::BISHOP] == 1 && board.pieceCounts[Color::BLACK][PieceType::BISHOP] == 1) {
             if (SameColorAsPiece(board.whitePieces[PieceType::BISHOP], board.blackPieces[PieceType::BISHOP]) != EmptyBitboard) {
                 return true;
             }
@@ -105,8 +192,13 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
     //1) Check for end game score
     Score endgameScore;
 
-    std::int32_t pieceCount = popCount(board.allPieces);
-    if (pieceCount <= 5) {
+    std::int32_t pieceCount = board.pieceCount;
+    if (pieceCount <= EndgameMaxPieces) {
+        //Bitbases know the result exactly, so they come before the hand-written functions
+        if (ProbeBitbases(board, endgameScore)) {
+            return endgameScore;
+        }
+
         bool endgameFound = this->endgame.probe(board, endgameScore);
 
         if (endgameFound) {
@@ -115,24 +207,51 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
     }
 
     //2) Check for lone king
-    else if (popCount(board.whitePieces[PieceType::ALL]) == 1
-        || popCount(board.blackPieces[PieceType::ALL]) == 1) {
+    else if (board.pieceCounts[Color::WHITE][PieceType::ALL] == 1
+        || board.pieceCounts[Color::BLACK][PieceType::ALL] == 1) {
         weakKingEndgameFunction(board, endgameScore);
         return endgameScore;
     }
 
-    //3) Check for lazy evaluation
-    Score lazyEvaluation = this->lazyEvaluate(board);
+    //3) Hand everything else to the network when one is loaded
+    if (NetworkEnabled) {
+        return this->networkEvaluator.evaluate(board, alpha, beta);
+    }
+
+    //4) Evaluate in stages, cheapest first.  Before each stage, stop if the remaining stages can't bring the score
+    //  back inside the window, judging by the most they have moved it so far.
+    this->evaluationCount++;
 
-    constexpr Score LazyThreshold = Score(4 * PAWN_SCORE);
-    if (lazyEvaluation + LazyThreshold < alpha
-        || lazyEvaluation - LazyThreshold >= beta) {
-        return lazyEvaluation;
+    Score result = this->lazyEvaluate(board);
+
+    if (this->canSkipStages(EvaluationStage::PAWN_STAGE, result, alpha, beta)) {
+        return result;
     }
 
-    //4) Continue, actually evaluating the board
+    //5) Evaluate Pawn Structure.  It comes first so the passed pawns are current for the pieces.  Since the Pawn
+    //  Evaluator is another evaluator, it will return score with side to move
+    Score lazyScore = result;
+
+    std::uint64_t stageStart = this->startProfile();
+    Score pawnScore = this->pawnEvaluator.evaluate(board, alpha, beta);
+    this->stopProfile(EvaluationStage::PAWN_STAGE, stageStart);
+
+    result += pawnScore;
+
+    if (this->canSkipStages(EvaluationStage::PIECE_STAGE, result, alpha, beta)) {
+        return result;
+    }
+
+    //6) Evaluate mobility, attacks, tropism and the piece specific terms
+    stageStart = this->startProfile();
+
     EvaluationTable evaluationTable;
-    Evaluation evaluation = board.materialEvaluation + board.pstEvaluation;
+    ChessEvaluation evaluation = board.materialEvaluation + board.pstEvaluation;
+
+    std::uint64_t termStart = this->startProfile();
+    this->evaluatePawnAttacks(board, evaluationTable);
+    this->evaluatePieceAttacks(board, evaluationTable);
+    this->stopProfile(EvaluationTerm::ATTACK_MAP_TERM, termStart);
 
     for (Color color = Color::WHITE; color < Color::COLOR_COUNT; color++) {
         bool colorIsWhite = color == Color::WHITE;
@@ -141,19 +260,15 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
         Bitboard* piecesToMove = colorIsWhite ? board.whitePieces : board.blackPieces;
         Bitboard* otherPieces = colorIsWhite ? board.blackPieces : board.whitePieces;
 
-        Direction left = colorIsWhite ? Direction::DOWN_LEFT : Direction::UP_LEFT;
-        Direction right = colorIsWhite ? Direction::DOWN_RIGHT : Direction::UP_RIGHT;
-
-        Bitboard unsafeSquares = ((otherPieces[PieceType::PAWN] & ~bbFile[File::_A]) + left) | ((otherPieces[PieceType::PAWN] & ~bbFile[File::_H]) + right);
-        evaluationTable.Attacks[~color][PieceType::PAWN] = unsafeSquares;
+        Bitboard unsafeSquares = evaluationTable.Attacks[~color][PieceType::PAWN];
 
         for (PieceType pieceType = PieceType::PAWN; pieceType <= PieceType::QUEEN; pieceType++) {
             Bitboard srcPieces = piecesToMove[pieceType];
             bool hasPiecePair = false;
 
             if (pieceType != PieceType::PAWN
-                && popCount(srcPieces) > 1) {
-                evaluation += multiplier * PiecePairs[pieceType];
+                && board.pieceCounts[color][pieceType] > 1) {
+                evaluation += multiplier * PiecePairValues[pieceType];
                 hasPiecePair = true;
             }
 
@@ -170,9 +285,12 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
 
                 Square otherKingPosition = color == Color::WHITE ? board.blackKingPosition : board.whiteKingPosition;
                 if (pieceType != PieceType::PAWN) {
+                    termStart = this->startProfile();
                     evaluation += multiplier * this->evaluateMobility(evaluationTable, mobilityDstSquares, board.allPieces, dstSquares, unsafeSquares, mobility, color, pieceType, src);
+                    this->stopProfile(EvaluationTerm::MOBILITY_TERM, termStart);
                 }
 
+                termStart = this->startProfile();
                 dstSquares &= otherPieces[PieceType::ALL];
 
                 Square dst;
@@ -185,30 +303,56 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
                     }
                 }
 
+                this->stopProfile(EvaluationTerm::ATTACK_TERM, termStart);
+
                 if (pieceType > PieceType::PAWN) {
+                    termStart = this->startProfile();
                     evaluation += multiplier * this->evaluateTropism(pieceType, src, otherKingPosition);
+                    this->stopProfile(EvaluationTerm::TROPISM_TERM, termStart);
 
                     Bitboard passedPawns = this->pawnEvaluator.getPassedPawns(color);
 
+                    termStart = this->startProfile();
+
                     switch (pieceType) {
                     case PieceType::BISHOP:
                         evaluation += multiplier * this->evaluateBishop(otherPieces, src, hasPiecePair);
+                        this->stopProfile(EvaluationTerm::BISHOP_TERM, termStart);
                         break;
                     case PieceType::ROOK:
                         evaluation += multiplier * this->evaluateRook(piecesToMove, board.allPieces, passedPawns, src, hasPiecePair);
+                        this->stopProfile(EvaluationTerm::ROOK_TERM, termStart);
                         break;
                     case PieceType::QUEEN:
                         evaluation += multiplier * this->evaluateQueen(board.allPieces, passedPawns, src);
+                        this->stopProfile(EvaluationTerm::QUEEN_TERM, termStart);
                     }
                 }
             }
         }
     }
 
-    //5) Evaluate Board Control
+    result = TaperEvaluation(evaluation, pieceCount);
+    result = (whiteToMove ? result : -result) + pawnScore;
+
+    Score pieceScore = result;
+
+    this->stopProfile(EvaluationStage::PIECE_STAGE, stageStart);
+
+    if (this->canSkipStages(EvaluationStage::CONTROL_STAGE, result, alpha, beta)) {
+        return result;
+    }
+
+    //7) Evaluate Board Control
+    stageStart = this->startProfile();
+
+    termStart = this->startProfile();
     evaluation += this->evaluateBoardControl(board, evaluationTable);
+    this->stopProfile(EvaluationTerm::BOARD_CONTROL_TERM, termStart);
+
+    //8) Evaluate Mobility difference
+    termStart = this->startProfile();
 
-    //6) Evaluate Mobility difference
     for (PieceType pieceType = PieceType::KNIGHT; pieceType <= PieceType::QUEEN; pieceType++) {
         std::int32_t betterMobility = evaluationTable.Mobility[Color::WHITE][pieceType] - evaluationTable.Mobility[Color::BLACK][pieceType];
         std::int32_t multiplier = 1;
@@ -217,30 +361,59 @@ Score ChessEvaluator::evaluateImplementation(BoardType& board, Score alpha, Scor
             multiplier = -1;
         }
 
-        evaluation += multiplier * BetterMobilityParameters[pieceType][multiplier * betterMobility];
+        evaluation += multiplier * BetterMobilityValues[pieceType][multiplier * betterMobility];
     }
 
-    //7) Begin Result Calculation
-    Score result = ((evaluation.mg * pieceCount) + (evaluation.eg * (32 - pieceCount))) / 32;
-    result = whiteToMove ? result : -result;
+    this->stopProfile(EvaluationTerm::BETTER_MOBILITY_TERM, termStart);
 
-    //8) Evaluate Pawn Structure.  Since the Pawn Evaluator is another evaluator, it will return score with side to move
-    result += this->pawnEvaluator.evaluate(board, alpha, beta);
+    //9) Final Result Calculation
+    result = TaperEvaluation(evaluation, pieceCount);
+    result = (whiteToMove ? result : -result) + pawnScore;
+
+    this->stopProfile(EvaluationStage::CONTROL_STAGE, stageStart);
+
+    //10) Every full evaluation measures how far each stage moved the score.  The margins keep the largest move seen since
+    //  the last new game or personality change.
+    this->measureStage(EvaluationStage::PAWN_STAGE, pawnScore);
+    this->measureStage(EvaluationStage::PIECE_STAGE, pieceScore - lazyScore - pawnScore);
+    this->measureStage(EvaluationStage::CONTROL_STAGE, result - pieceScore);
 
     return result;
 }
 
-Evaluation ChessEvaluator::evaluateAttacks(PieceType srcPiece, PieceType attackedPiece)
+ChessEvaluation ChessEvaluator::evaluateAttacks(PieceType srcPiece, PieceType attackedPiece)
 {
-    return AttackParameters[srcPiece][attackedPiece];
+    return AttackValues[srcPiece][attackedPiece];
 }
 
-Evaluation ChessEvaluator::evaluateBoardControl(BoardType& board, EvaluationTable& evaluationTable)
+ChessEvaluation ChessEvaluator::evaluateBoardControl(BoardType& board, EvaluationTable& evaluationTable)
 {
     Bitboard whiteControl = EmptyBitboard;
     Bitboard blackControl = EmptyBitboard;
 
     //1) Calculate which squares are controlled by which piece on which side
+#ifdef USE_M128I
+    //White is in the low lane and black in the high lane; swapping the lanes gives the other side's squares
+    __m128i control = _mm_setzero_si128();
+
+    for (PieceType pieceType = PieceType::PAWN; pieceType < PieceType::KING; pieceType++) {
+        __m128i allControl = _mm_or_si128(control, _mm_shuffle_epi32(control, 0x4e));
+
+        __m128i attacks = _mm_set_epi64x(evaluationTable.Attacks[Color::BLACK][pieceType], evaluationTable.Attacks[Color::WHITE][pieceType]);
+        attacks = _mm_andnot_si128(allControl, attacks);
+
+        __m128i commonAttacks = _mm_and_si128(attacks, _mm_shuffle_epi32(attacks, 0x4e));
+        attacks = _mm_andnot_si128(commonAttacks, attacks);
+
+        control = _mm_or_si128(control, attacks);
+
+        evaluationTable.WhiteControl[pieceType] = Bitboard(_mm_cvtsi128_si64(attacks));
+        evaluationTable.BlackControl[pieceType] = Bitboard(_mm_extract_epi64(attacks, 1));
+    }
+
+    whiteControl = Bitboard(_mm_cvtsi128_si64(control));
+    blackControl = Bitboard(_mm_extract_epi64(control, 1));
+#else
     for (PieceType pieceType = PieceType::PAWN; pieceType < PieceType::KING; pieceType++) {
         Bitboard allControl = whiteControl | blackControl;
 
@@ -258,6 +431,7 @@ Evaluation ChessEvaluator::evaluateBoardControl(BoardType& board, EvaluationTabl
         evaluationTable.WhiteControl[pieceType] = whiteAttacks;
         evaluationTable.BlackControl[pieceType] = blackAttacks;
     }
+#endif
 
     assert((whiteControl & blackControl) == EmptyBitboard);
 
@@ -268,34 +442,83 @@ Evaluation ChessEvaluator::evaluateBoardControl(BoardType& board, EvaluationTabl
     Bitboard whiteKingControl = whiteControl & PieceMoves[PieceType::KING][board.blackKingPosition];
     Bitboard blackKingControl = blackControl & PieceMoves[PieceType::KING][board.whiteKingPosition];
 
-    Evaluation result = { ZERO_SCORE, ZERO_SCORE };
+    //3) Black's squares are mirrored into white's PST by flipping the ranks
+    Bitboard flippedBlackControl = SwapBytes(blackControl);
+    Bitboard flippedBlackKingControl = SwapBytes(blackKingControl);
 
-    Square dst;
-    for (Color color = Color::WHITE; color < Color::COLOR_COUNT; color++) {
-        bool colorIsWhite = color == Color::WHITE;
-        std::int32_t multiplier = colorIsWhite ? 1 : -1;
+    Score mg = SumPstPlanes(BoardControlMgPlanes, whiteControl) - SumPstPlanes(BoardControlMgPlanes, flippedBlackControl)
+        + SumPstPlanes(KingControlMgPlanes, whiteKingControl) - SumPstPlanes(KingControlMgPlanes, flippedBlackKingControl);
+    Score eg = SumPstPlanes(BoardControlEgPlanes, whiteControl) - SumPstPlanes(BoardControlEgPlanes, flippedBlackControl)
+        + SumPstPlanes(KingControlEgPlanes, whiteKingControl) - SumPstPlanes(KingControlEgPlanes, flippedBlackKingControl);
 
-        Bitboard colorControl = colorIsWhite ? whiteControl : blackControl;
-        while (BitScanForward64((std::uint32_t*) & dst, colorControl)) {
-            colorControl = ResetLowestSetBit(colorControl);
+    return MakeChessEvaluation(mg, eg);
+}
 
-            dst = colorIsWhite ? dst : FlipSqY(dst);
-            result += multiplier * BoardControlPstParameters[dst];
-        }
+void ChessEvaluator::evaluatePawnAttacks(BoardType& board, EvaluationTable& evaluationTable)
+{
+    Bitboard notFileA = ~bbFile[File::_A];
+    Bitboard notFileH = ~bbFile[File::_H];
+
+#ifdef USE_M128I
+    //Black's pawns are byte swapped so that both lanes attack up the board.  Swapping only flips ranks, so the file
+    //  masks are the same for both lanes.
+    __m128i pawns = _mm_set_epi64x(SwapBytes(board.blackPieces[PieceType::PAWN]), board.whitePieces[PieceType::PAWN]);
+
+    __m128i leftAttacks = _mm_srli_epi64(_mm_and_si128(pawns, _mm_set1_epi64x(notFileA)), -Direction::UP_LEFT);
+    __m128i rightAttacks = _mm_srli_epi64(_mm_and_si128(pawns, _mm_set1_epi64x(notFileH)), -Direction::UP_RIGHT);
+    __m128i attacks = _mm_or_si128(leftAttacks, rightAttacks);
+
+    evaluationTable.Attacks[Color::WHITE][PieceType::PAWN] = Bitboard(_mm_cvtsi128_si64(attacks));
+    evaluationTable.Attacks[Color::BLACK][PieceType::PAWN] = SwapBytes(Bitboard(_mm_extract_epi64(attacks, 1)));
+#else
+    Bitboard whitePawns = board.whitePieces[PieceType::PAWN];
+    Bitboard blackPawns = board.blackPieces[PieceType::PAWN];
+
+    evaluationTable.Attacks[Color::WHITE][PieceType::PAWN] = ((whitePawns & notFileA) + Direction::UP_LEFT) | ((whitePawns & notFileH) + Direction::UP_RIGHT);
+    evaluationTable.Attacks[Color::BLACK][PieceType::PAWN] = ((blackPawns & notFileA) + Direction::DOWN_LEFT) | ((blackPawns & notFileH) + Direction::DOWN_RIGHT);
+#endif
+}
 
-        Bitboard colorKingControl = colorIsWhite ? whiteKingControl : blackKingControl;
-        while (BitScanForward64((std::uint32_t*) & dst, colorKingControl)) {
-            colorKingControl = ResetLowestSetBit(colorKingControl);
+void ChessEvaluator::evaluatePieceAttacks(BoardType& board, EvaluationTable& evaluationTable)
+{
+#ifdef USE_M128I
+    //White is in the low lane and black in the high lane, like the pawn attacks
+    __m128i empty = _mm_set1_epi64x(~board.allPieces);
+
+    __m128i knights = _mm_set_epi64x(board.blackPieces[PieceType::KNIGHT], board.whitePieces[PieceType::KNIGHT]);
+    __m128i bishops = _mm_set_epi64x(board.blackPieces[PieceType::BISHOP], board.whitePieces[PieceType::BISHOP]);
+    __m128i rooks = _mm_set_epi64x(board.blackPieces[PieceType::ROOK], board.whitePieces[PieceType::ROOK]);
+    __m128i queens = _mm_set_epi64x(board.blackPieces[PieceType::QUEEN], board.whitePieces[PieceType::QUEEN]);
+
+    __m128i knightAttacks = KnightSetAttacks(knights);
+    __m128i bishopAttacks = BishopSetAttacks(bishops, empty);
+    __m128i rookAttacks = RookSetAttacks(rooks, empty);
+    __m128i queenAttacks = _mm_or_si128(BishopSetAttacks(queens, empty), RookSetAttacks(queens, empty));
+
+    evaluationTable.Attacks[Color::WHITE][PieceType::KNIGHT] = Bitboard(_mm_cvtsi128_si64(knightAttacks));
+    evaluationTable.Attacks[Color::BLACK][PieceType::KNIGHT] = Bitboard(_mm_extract_epi64(knightAttacks, 1));
+    evaluationTable.Attacks[Color::WHITE][PieceType::BISHOP] = Bitboard(_mm_cvtsi128_si64(bishopAttacks));
+    evaluationTable.Attacks[Color::BLACK][PieceType::BISHOP] = Bitboard(_mm_extract_epi64(bishopAttacks, 1));
+    evaluationTable.Attacks[Color::WHITE][PieceType::ROOK] = Bitboard(_mm_cvtsi128_si64(rookAttacks));
+    evaluationTable.Attacks[Color::BLACK][PieceType::ROOK] = Bitboard(_mm_extract_epi64(rookAttacks, 1));
+    evaluationTable.Attacks[Color::WHITE][PieceType::QUEEN] = Bitboard(_mm_cvtsi128_si64(queenAttacks));
+    evaluationTable.Attacks[Color::BLACK][PieceType::QUEEN] = Bitboard(_mm_extract_epi64(queenAttacks, 1));
+#else
+    Bitboard empty = ~board.allPieces;
 
-            dst = colorIsWhite ? dst : FlipSqY(dst);
-            result += multiplier * KingControlPstParameters[dst];
-        }
-    }
+    for (Color color = Color::WHITE; color < Color::COLOR_COUNT; color++) {
+        Bitboard* pieces = color == Color::WHITE ? board.whitePieces : board.blackPieces;
 
-    return result;
+        evaluationTable.Attacks[color][PieceType::KNIGHT] = KnightSetAttacks(pieces[PieceType::KNIGHT]);
+        evaluationTable.Attacks[color][PieceType::BISHOP] = BishopSetAttacks(pieces[PieceType::BISHOP], empty);
+        evaluationTable.Attacks[color][PieceType::ROOK] = RookSetAttacks(pieces[PieceType::ROOK], empty);
+        evaluationTable.Attacks[color][PieceType::QUEEN] = BishopSetAttacks(pieces[PieceType::QUEEN], empty)
+            | RookSetAttacks(pieces[PieceType::QUEEN], empty);
+    }
+#endif
 }
 
-Evaluation ChessEvaluator::evaluateMobility(EvaluationTable& evaluationTable, Bitboard& outDstSquares, Bitboard allPieces, Bitboard dstSquares, Bitboard unsafeSquares, std::int32_t& mobility, Color movingSide, PieceType pieceType, Square src)
+ChessEvaluation ChessEvaluator::evaluateMobility(EvaluationTable& evaluationTable, Bitboard& outDstSquares, Bitboard allPieces, Bitboard dstSquares, Bitboard unsafeSquares, std::int32_t& mobility, Color movingSide, PieceType pieceType, Square src)
 {
     outDstSquares = dstSquares;
 
@@ -312,16 +535,15 @@ Evaluation ChessEvaluator::evaluateMobility(EvaluationTable& evaluationTable, Bi
             dstSquares = ResetLowestSetBit(dstSquares);
 
             if ((InBetween[src][dst] & allPieces) != EmptyBitboard) {
-                outDstSquares ^= dst;
+                outDstSquares &= ~OneShiftedBy(dst);
             }
         }
 
         break;
     default:
-        return { ZERO_SCORE, ZERO_SCORE };
+        return ZeroChessEvaluation;
     }
 
-    evaluationTable.Attacks[movingSide][pieceType] = outDstSquares;
     mobility = popCount(outDstSquares);
 
     Bitboard safeDstSquares = outDstSquares & ~unsafeSquares;
@@ -330,38 +552,38 @@ Evaluation ChessEvaluator::evaluateMobility(EvaluationTable& evaluationTable, Bi
     evaluationTable.Mobility[movingSide][pieceType] = mobility;
     evaluationTable.SafeMobility[movingSide][pieceType] = safeMobility;
 
-    return MobilityParameters[pieceType][mobility] + SafeMobilityParameters[pieceType][safeMobility];
+    return MobilityValues[pieceType][mobility] + SafeMobilityValues[pieceType][safeMobility];
 }
 
-Evaluation ChessEvaluator::evaluateTropism(PieceType pieceType, Square src, Square otherKingPosition)
+ChessEvaluation ChessEvaluator::evaluateTropism(PieceType pieceType, Square src, Square otherKingPosition)
 {
     std::uint32_t tropism = Distance[FileDistance(otherKingPosition, src)][RankDistance(otherKingPosition, src)];
 
-    return TropismParameters[pieceType][tropism];
+    return TropismValues[pieceType][tropism];
 }
 
-Evaluation ChessEvaluator::evaluateBishop(Bitboard* otherPieces, Square src, bool hasPiecePair)
+ChessEvaluation ChessEvaluator::evaluateBishop(Bitboard* otherPieces, Square src, bool hasPiecePair)
 {
-    Evaluation result = { ZERO_SCORE, ZERO_SCORE };
+    ChessEvaluation result = ZeroChessEvaluation;
 
     if (!hasPiecePair) {
         std::int32_t goodPawnCount = popCount(SquaresSameColorAs(otherPieces[PieceType::PAWN], src));
         std::int32_t badPawnCount = popCount(SquaresOppositeColorAs(otherPieces[PieceType::PAWN], src));
 
         if (goodPawnCount > badPawnCount) {
-            result += GoodBishopPawns[goodPawnCount - badPawnCount];
+            result += GoodBishopPawnValues[goodPawnCount - badPawnCount];
         }
         else if (goodPawnCount < badPawnCount) {
-            result -= GoodBishopPawns[badPawnCount - goodPawnCount];
+            result -= GoodBishopPawnValues[badPawnCount - goodPawnCount];
         }
     }
 
     return result;
 }
 
-Evaluation ChessEvaluator::evaluateRook(Bitboard* piecesToMove, Bitboard allPieces, Bitboard passedPawns, Square src, bool hasPiecePair)
+ChessEvaluation ChessEvaluator::evaluateRook(Bitboard* piecesToMove, Bitboard allPieces, Bitboard passedPawns, Square src, bool hasPiecePair)
 {
-    Evaluation result = { ZERO_SCORE, ZERO_SCORE };
+    ChessEvaluation result = ZeroChessEvaluation;
 
     if (hasPiecePair) {
         Bitboard otherRooks = piecesToMove[PieceType::ROOK] & PieceMoves[PieceType::ROOK][src];
@@ -373,7 +595,7 @@ Evaluation ChessEvaluator::evaluateRook(Bitboard* piecesToMove, Bitboard allPiec
                 otherRooks = ResetLowestSetBit(otherRooks);
 
                 if ((InBetween[src][dst] & allPieces) != EmptyBitboard) {
-                    result += DoubledRooks;
+                    result += DoubledRooksValue;
                 }
             }
         }
@@ -383,7 +605,7 @@ Evaluation ChessEvaluator::evaluateRook(Bitboard* piecesToMove, Bitboard allPiec
     Bitboard piecesInSameFile = allPieces & bbFile[file];
 
     if (piecesInSameFile == OneShiftedBy(src)) {
-        result += EmptyFileRook;
+        result += EmptyFileRookValue;
     }
     else if ((piecesInSameFile & passedPawns) != EmptyBitboard) {
         Square src;
@@ -391,22 +613,22 @@ Evaluation ChessEvaluator::evaluateRook(Bitboard* piecesToMove, Bitboard allPiec
             BitScanForward64((std::uint32_t*) & src, passedPawns);
             passedPawns = ResetLowestSetBit(passedPawns);
 
-            result += RookBehindPassedPawnPst[src];
+            result += RookBehindPassedPawnPstValues[src];
         }
     }
 
     return result;
 }
 
-Evaluation ChessEvaluator::evaluateQueen(Bitboard allPieces, Bitboard passedPawns, Square src)
+ChessEvaluation ChessEvaluator::evaluateQueen(Bitboard allPieces, Bitboard passedPawns, Square src)
 {
-    Evaluation result = { ZERO_SCORE, ZERO_SCORE };
+    ChessEvaluation result = ZeroChessEvaluation;
 
     File file = getFile(src);
     Bitboard piecesInSameFile = allPieces & bbFile[file];
 
     if (piecesInSameFile == OneShiftedBy(src)) {
-        result += EmptyFileQueen;
+        result += EmptyFileQueenValue;
     }
     else if ((piecesInSameFile & passedPawns) != EmptyBitboard) {
         Square src;
@@ -414,20 +636,77 @@ Evaluation ChessEvaluator::evaluateQueen(Bitboard allPieces, Bitboard passedPawn
             BitScanForward64((std::uint32_t*) & src, passedPawns);
             passedPawns = ResetLowestSetBit(passedPawns);
 
-            result += QueenBehindPassedPawnPst[src];
+            result += QueenBehindPassedPawnPstValues[src];
         }
     }
 
     return result;
 }
 
+#ifdef USE_EVALUATION_PROFILE
+//Shares are of the cycles spent in all three stages, so the terms add up to less than the stages that contain them
+static void PrintProfile(const std::string& name, std::uint64_t cycles, std::uint64_t calls, std::uint64_t totalCycles)
+{
+    std::cout << std::left << std::setw(16) << name << std::right
+        << " calls " << std::setw(12) << calls
+        << " cycles " << std::setw(14) << cycles
+        << " per call " << std::setw(8) << (calls != 0 ? double(cycles) / calls : 0.0)
+        << " share " << std::setw(5) << (totalCycles != 0 ? 100.0 * cycles / totalCycles : 0.0) << "%" << std::endl;
+}
+#endif
+
+void ChessEvaluator::printStatistics()
+{
+    static const std::string stageNames[EvaluationStage::EVALUATIONSTAGE_COUNT] = { "pawns", "pieces", "control" };
+
+    std::uint64_t skipped = 0;
+
+    std::cout << "Evaluations: " << this->evaluationCount << std::endl;
+
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        skipped += this->skippedStages[stage];
+
+        std::cout << "Skipped " << stageNames[stage] << ": " << skipped;
+
+        if (this->evaluationCount != 0) {
+            std::cout << " (" << std::fixed << std::setprecision(1) << (100.0 * skipped / this->evaluationCount) << "%)";
+        }
+
+        std::cout << std::endl;
+    }
+
+#ifdef USE_EVALUATION_PROFILE
+    static const std::string termNames[EvaluationTerm::EVALUATIONTERM_COUNT] = {
+        "attack maps", "mobility", "attacks", "tropism", "bishops", "rooks", "queens", "board control", "better mobility"
+    };
+
+    std::uint64_t totalCycles = 0;
+
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        totalCycles += this->stageCycles[stage];
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (EvaluationStage stage = EvaluationStage::PAWN_STAGE; stage < EvaluationStage::EVALUATIONSTAGE_COUNT; stage++) {
+        PrintProfile(stageNames[stage] + " stage", this->stageCycles[stage], this->stageCalls[stage], totalCycles);
+    }
+
+    for (EvaluationTerm term = EvaluationTerm::ATTACK_MAP_TERM; term < EvaluationTerm::EVALUATIONTERM_COUNT; term++) {
+        PrintProfile(termNames[term], this->termCycles[term], this->termCalls[term], totalCycles);
+    }
+#endif
+}
+
 Score ChessEvaluator::lazyEvaluateImplementation(BoardType& board)
 {
-    Evaluation evaluation = board.materialEvaluation + board.pstEvaluation;
+    if (NetworkEnabled) {
+        return this->networkEvaluator.lazyEvaluate(board);
+    }
 
-    std::int32_t pieceCount = popCount(board.allPieces);
+    ChessEvaluation evaluation = board.materialEvaluation + board.pstEvaluation;
 
-    Score result = ((evaluation.mg * pieceCount) + (evaluation.eg * (32 - pieceCount))) / 32;
+    Score result = TaperEvaluation(evaluation, board.pieceCount);
 
     bool whiteToMove = board.sideToMove == Color::WHITE;
 
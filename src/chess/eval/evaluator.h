@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "networkevaluator.h"
 #include "pawnevaluator.h"
 
 #include "../board/board.h"
@@ -26,6 +27,26 @@
 
 #include "../../game/eval/evaluator.h"
 
+enum EvaluationStage {
+    PAWN_STAGE, PIECE_STAGE, CONTROL_STAGE, EVALUATIONSTAGE_COUNT
+};
+
+static EvaluationStage& operator ++ (EvaluationStage& stage, int)
+{
+    return stage = EvaluationStage(int(stage) + 1);
+}
+
+//Terms timed by USE_EVALUATION_PROFILE.  The pawn structure is timed as the pawn stage.
+enum EvaluationTerm {
+    ATTACK_MAP_TERM, MOBILITY_TERM, ATTACK_TERM, TROPISM_TERM, BISHOP_TERM, ROOK_TERM, QUEEN_TERM, BOARD_CONTROL_TERM,
+    BETTER_MOBILITY_TERM, EVALUATIONTERM_COUNT
+};
+
+static EvaluationTerm& operator ++ (EvaluationTerm& term, int)
+{
+    return term = EvaluationTerm(int(term) + 1);
+}
+
 struct EvaluationTable
 {
     Bitboard Attacks[Color::COLOR_COUNT][PieceType::PIECETYPE_COUNT];
@@ -44,16 +65,37 @@ struct EvaluationTable
 class ChessEvaluator : public Evaluator<ChessEvaluator, ChessBoard>
 {
     ChessEndgame endgame;
+    ChessNetworkEvaluator networkEvaluator;
     ChessPawnEvaluator pawnEvaluator;
 
-    Evaluation evaluateAttacks(PieceType srcPiece, PieceType attackedPiece);
-    Evaluation evaluateBoardControl(BoardType& board, EvaluationTable& evaluationTable);
-    Evaluation evaluateMobility(EvaluationTable& evaluationTable, Bitboard& outDstSquares, Bitboard allPieces, Bitboard dstSquares, Bitboard unsafeSquares, std::int32_t& mobility, Color movingSide, PieceType pieceType, Square src);
-    Evaluation evaluateTropism(PieceType pieceType, Square src, Square otherKingPosition);
-
-    Evaluation evaluateBishop(Bitboard* otherPieces, Square src, bool hasPiecePair);
-    Evaluation evaluateRook(Bitboard* piecesToMove, Bitboard allPieces, Bitboard passedPawns, Square src, bool hasPiecePair);
-    Evaluation evaluateQueen(Bitboard allPieces, Bitboard passedPawns, Square src);
+    std::uint64_t evaluationCount;
+    std::uint64_t skippedStages[EvaluationStage::EVALUATIONSTAGE_COUNT];
+    Score stageMargins[EvaluationStage::EVALUATIONSTAGE_COUNT];
+
+#ifdef USE_EVALUATION_PROFILE
+    std::uint64_t stageCycles[EvaluationStage::EVALUATIONSTAGE_COUNT];
+    std::uint64_t stageCalls[EvaluationStage::EVALUATIONSTAGE_COUNT];
+    std::uint64_t termCycles[EvaluationTerm::EVALUATIONTERM_COUNT];
+    std::uint64_t termCalls[EvaluationTerm::EVALUATIONTERM_COUNT];
+#endif
+
+    bool canSkipStages(EvaluationStage stage, Score score, Score alpha, Score beta);
+    void measureStage(EvaluationStage stage, Score contribution);
+
+    std::uint64_t startProfile();
+    void stopProfile(EvaluationStage stage, std::uint64_t start);
+    void stopProfile(EvaluationTerm term, std::uint64_t start);
+
+    ChessEvaluation evaluateAttacks(PieceType srcPiece, PieceType attackedPiece);
+    ChessEvaluation evaluateBoardControl(BoardType& board, EvaluationTable& evaluationTable);
+    void evaluatePawnAttacks(BoardType& board, EvaluationTable& evaluationTable);
+    void evaluatePieceAttacks(BoardType& board, EvaluationTable& evaluationTable);
+    ChessEvaluation evaluateMobility(EvaluationTable& evaluationTable, Bitboard& outDstSquares, Bitboard allPieces, Bitboard dstSquares, Bitboard unsafeSquares, std::int32_t& mobility, Color movingSide, PieceType pieceType, Square src);
+    ChessEvaluation evaluateTropism(PieceType pieceType, Square src, Square otherKingPosition);
+
+    ChessEvaluation evaluateBishop(Bitboard* otherPieces, Square src, bool hasPiecePair);
+    ChessEvaluation evaluateRook(Bitboard* piecesToMove, Bitboard allPieces, Bitboard passedPawns, Square src, bool hasPiecePair);
+    ChessEvaluation evaluateQueen(Bitboard allPieces, Bitboard passedPawns, Square src);
 public:
 	ChessEvaluator();
 	~ChessEvaluator();
@@ -63,4 +105,8 @@ public:
 	Score evaluateImplementation(BoardType& board, Score alpha, Score beta);
 
 	Score lazyEvaluateImplementation(BoardType& board);
+
+    void printStatistics();
+
+    void resetStageMargins();
 };
@@ -0,0 +1,285 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(USE_M256I)
+#include <immintrin.h>
+#elif defined(USE_M128I)
+#include <nmmintrin.h>
+#endif
+
+#include "network.h"
+
+bool NetworkEnabled = false;
+
+alignas(32) static std::int16_t FeatureWeights[NetworkInputSize][NetworkAccumulatorSize];
+alignas(32) static std::int16_t FeatureBiases[NetworkAccumulatorSize];
+
+alignas(32) static std::int8_t Hidden1Weights[NetworkHiddenSize][2 * NetworkAccumulatorSize];
+static std::int32_t Hidden1Biases[NetworkHiddenSize];
+
+alignas(32) static std::int8_t Hidden2Weights[NetworkHiddenSize][NetworkHiddenSize];
+static std::int32_t Hidden2Biases[NetworkHiddenSize];
+
+alignas(32) static std::int8_t OutputWeights[1][NetworkHiddenSize];
+static std::int32_t OutputBias[1];
+
+//"JWNN" read as a little endian integer
+static constexpr std::uint32_t NetworkFileMagic = 0x4e4e574a;
+static constexpr std::uint32_t NetworkFileVersion = 1;
+
+void AddNetworkFeature(std::int16_t* accumulator, std::uint32_t feature)
+{
+    const std::int16_t* column = FeatureWeights[feature];
+
+#if defined(USE_M256I)
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i += 16) {
+        __m256i* values = (__m256i*)(accumulator + i);
+        _mm256_store_si256(values, _mm256_add_epi16(_mm256_load_si256(values), _mm256_load_si256((const __m256i*)(column + i))));
+    }
+#elif defined(USE_M128I)
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i += 8) {
+        __m128i* values = (__m128i*)(accumulator + i);
+        _mm_store_si128(values, _mm_add_epi16(_mm_load_si128(values), _mm_load_si128((const __m128i*)(column + i))));
+    }
+#else
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i++) {
+        accumulator[i] += column[i];
+    }
+#endif
+}
+
+void RemoveNetworkFeature(std::int16_t* accumulator, std::uint32_t feature)
+{
+    const std::int16_t* column = FeatureWeights[feature];
+
+#if defined(USE_M256I)
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i += 16) {
+        __m256i* values = (__m256i*)(accumulator + i);
+        _mm256_store_si256(values, _mm256_sub_epi16(_mm256_load_si256(values), _mm256_load_si256((const __m256i*)(column + i))));
+    }
+#elif defined(USE_M128I)
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i += 8) {
+        __m128i* values = (__m128i*)(accumulator + i);
+        _mm_store_si128(values, _mm_sub_epi16(_mm_load_si128(values), _mm_load_si128((const __m128i*)(column + i))));
+    }
+#else
+    for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i++) {
+        accumulator[i] -= column[i];
+    }
+#endif
+}
+
+void ResetNetworkAccumulator(std::int16_t* accumulator)
+{
+    std::copy(FeatureBiases, FeatureBiases + NetworkAccumulatorSize, accumulator);
+}
+
+//Clamp both accumulators to [0, 127], side to move first
+static void transformAccumulatorReference(NetworkAccumulator& accumulator, Color sideToMove, std::uint8_t* output)
+{
+    for (std::uint32_t side = 0; side < Color::COLOR_COUNT; side++) {
+        Color perspective = side == 0 ? sideToMove : ~sideToMove;
+
+        for (std::uint32_t i = 0; i < NetworkAccumulatorSize; i++) {
+            std::int32_t value = accumulator.values[perspective][i];
+            output[side * NetworkAccumulatorSize + i] = std::uint8_t(std::clamp(value, 0, NetworkActivationMax));
+        }
+    }
+}
+
+static void propagateLayerReference(const std::uint8_t* input, const std::int8_t* weights, const std::int32_t* biases, std::int32_t* output, std::uint32_t inputSize, std::uint32_t outputSize)
+{
+    for (std::uint32_t i = 0; i < outputSize; i++) {
+        std::int32_t sum = biases[i];
+
+        for (std::uint32_t j = 0; j < inputSize; j++) {
+            sum += std::int32_t(input[j]) * std::int32_t(weights[i * inputSize + j]);
+        }
+
+        output[i] = sum;
+    }
+}
+
+static void transformAccumulator(NetworkAccumulator& accumulator, Color sideToMove, std::uint8_t* output)
+{
+#if defined(USE_M256I)
+    const __m256i activationMax = _mm256_set1_epi16(NetworkActivationMax);
+
+    for (std::uint32_t side = 0; side < Color::COLOR_COUNT; side++) {
+        Color perspective = side == 0 ? sideToMove : ~sideToMove;
+        const __m256i* values = (const __m256i*)accumulator.values[perspective];
+
+        for (std::uint32_t i = 0; i < NetworkAccumulatorSize / 32; i++) {
+            __m256i low = _mm256_min_epi16(_mm256_load_si256(values + 2 * i), activationMax);
+            __m256i high = _mm256_min_epi16(_mm256_load_si256(values + 2 * i + 1), activationMax);
+
+            //packus works within 128 bit lanes, so put the quadwords back in order afterwards
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8);
+            _mm256_store_si256((__m256i*)(output + side * NetworkAccumulatorSize) + i, packed);
+        }
+    }
+#elif defined(USE_M128I)
+    const __m128i activationMax = _mm_set1_epi16(NetworkActivationMax);
+
+    for (std::uint32_t side = 0; side < Color::COLOR_COUNT; side++) {
+        Color perspective = side == 0 ? sideToMove : ~sideToMove;
+        const __m128i* values = (const __m128i*)accumulator.values[perspective];
+
+        for (std::uint32_t i = 0; i < NetworkAccumulatorSize / 16; i++) {
+            __m128i low = _mm_min_epi16(_mm_load_si128(values + 2 * i), activationMax);
+            __m128i high = _mm_min_epi16(_mm_load_si128(values + 2 * i + 1), activationMax);
+
+            _mm_store_si128((__m128i*)(output + side * NetworkAccumulatorSize) + i, _mm_packus_epi16(low, high));
+        }
+    }
+#else
+    transformAccumulatorReference(accumulator, sideToMove, output);
+#endif
+}
+
+//The input is at most 127, so the pairwise sums in maddubs can not saturate
+static void propagateLayer(const std::uint8_t* input, const std::int8_t* weights, const std::int32_t* biases, std::int32_t* output, std::uint32_t inputSize, std::uint32_t outputSize)
+{
+#if defined(USE_M256I)
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (std::uint32_t i = 0; i < outputSize; i++) {
+        const __m256i* row = (const __m256i*)(weights + i * inputSize);
+        __m256i sum = _mm256_setzero_si256();
+
+        for (std::uint32_t j = 0; j < inputSize / 32; j++) {
+            __m256i product = _mm256_maddubs_epi16(_mm256_load_si256((const __m256i*)input + j), _mm256_load_si256(row + j));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, ones));
+        }
+
+        __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        total = _mm_hadd_epi32(total, total);
+        total = _mm_hadd_epi32(total, total);
+
+        output[i] = biases[i] + _mm_cvtsi128_si32(total);
+    }
+#elif defined(USE_M128I)
+    const __m128i ones = _mm_set1_epi16(1);
+
+    for (std::uint32_t i = 0; i < outputSize; i++) {
+        const __m128i* row = (const __m128i*)(weights + i * inputSize);
+        __m128i sum = _mm_setzero_si128();
+
+        for (std::uint32_t j = 0; j < inputSize / 16; j++) {
+            __m128i product = _mm_maddubs_epi16(_mm_load_si128((const __m128i*)input + j), _mm_load_si128(row + j));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(product, ones));
+        }
+
+        sum = _mm_hadd_epi32(sum, sum);
+        sum = _mm_hadd_epi32(sum, sum);
+
+        output[i] = biases[i] + _mm_cvtsi128_si32(sum);
+    }
+#else
+    propagateLayerReference(input, weights, biases, output, inputSize, outputSize);
+#endif
+}
+
+static void activateLayer(const std::int32_t* input, std::uint8_t* output, std::uint32_t size)
+{
+    for (std::uint32_t i = 0; i < size; i++) {
+        output[i] = std::uint8_t(std::clamp(input[i] >> NetworkWeightShift, 0, NetworkActivationMax));
+    }
+}
+
+template <bool reference>
+static Score evaluateNetwork(NetworkAccumulator& accumulator, Color sideToMove)
+{
+    alignas(32) std::uint8_t transformed[2 * NetworkAccumulatorSize];
+    alignas(32) std::int32_t hidden[NetworkHiddenSize];
+    alignas(32) std::uint8_t activated1[NetworkHiddenSize];
+    alignas(32) std::uint8_t activated2[NetworkHiddenSize];
+    std::int32_t output;
+
+    auto transform = reference ? transformAccumulatorReference : transformAccumulator;
+    auto propagate = reference ? propagateLayerReference : propagateLayer;
+
+    //1) Clamp the accumulators into the first layer's input
+    transform(accumulator, sideToMove, transformed);
+
+    //2) Run the hidden layers
+    propagate(transformed, &Hidden1Weights[0][0], Hidden1Biases, hidden, 2 * NetworkAccumulatorSize, NetworkHiddenSize);
+    activateLayer(hidden, activated1, NetworkHiddenSize);
+
+    propagate(activated1, &Hidden2Weights[0][0], Hidden2Biases, hidden, NetworkHiddenSize, NetworkHiddenSize);
+    activateLayer(hidden, activated2, NetworkHiddenSize);
+
+    //3) The output is from the side to move's point of view
+    propagate(activated2, &OutputWeights[0][0], OutputBias, &output, NetworkHiddenSize, 1);
+
+    return Score(output / NetworkOutputScale);
+}
+
+Score EvaluateNetwork(NetworkAccumulator& accumulator, Color sideToMove)
+{
+    return evaluateNetwork<false>(accumulator, sideToMove);
+}
+
+Score EvaluateNetworkReference(NetworkAccumulator& accumulator, Color sideToMove)
+{
+    return evaluateNetwork<true>(accumulator, sideToMove);
+}
+
+//The file is the header (magic, version, accumulator size, hidden size) followed by every table in declaration order,
+//  all little endian.
+bool LoadNetwork(const std::string& networkFileName)
+{
+    std::ifstream networkFile(networkFileName, std::ios_base::in | std::ios_base::binary);
+
+    NetworkEnabled = false;
+
+    if (!networkFile.is_open()) {
+        return false;
+    }
+
+    std::uint32_t header[4];
+    networkFile.read((char*)header, sizeof(header));
+
+    if (!networkFile
+        || header[0] != NetworkFileMagic
+        || header[1] != NetworkFileVersion
+        || header[2] != NetworkAccumulatorSize
+        || header[3] != NetworkHiddenSize) {
+        return false;
+    }
+
+    networkFile.read((char*)FeatureWeights, sizeof(FeatureWeights));
+    networkFile.read((char*)FeatureBiases, sizeof(FeatureBiases));
+    networkFile.read((char*)Hidden1Weights, sizeof(Hidden1Weights));
+    networkFile.read((char*)Hidden1Biases, sizeof(Hidden1Biases));
+    networkFile.read((char*)Hidden2Weights, sizeof(Hidden2Weights));
+    networkFile.read((char*)Hidden2Biases, sizeof(Hidden2Biases));
+    networkFile.read((char*)OutputWeights, sizeof(OutputWeights));
+    networkFile.read((char*)OutputBias, sizeof(OutputBias));
+
+    if (!networkFile) {
+        return false;
+    }
+
+    NetworkEnabled = true;
+
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "../../game/types/color.h"
+#include "../../game/types/score.h"
+
+#include "../types/piece.h"
+#include "../types/square.h"
+
+//The network is a king-relative piece-square input layer feeding two accumulators (one per perspective), followed by
+//  two small hidden layers and a single output.  The accumulators live on the board and are updated in doMove.
+static constexpr std::uint32_t NetworkPieceCount = 10;
+static constexpr std::uint32_t NetworkInputSize = Square::SQUARE_COUNT * NetworkPieceCount * Square::SQUARE_COUNT;
+static constexpr std::uint32_t NetworkAccumulatorSize = 128;
+static constexpr std::uint32_t NetworkHiddenSize = 32;
+
+static constexpr std::int32_t NetworkActivationMax = 127;
+static constexpr std::int32_t NetworkWeightShift = 6;
+static constexpr std::int32_t NetworkOutputScale = 16;
+
+struct NetworkAccumulator
+{
+    alignas(32) std::int16_t values[Color::COLOR_COUNT][NetworkAccumulatorSize];
+};
+
+extern bool NetworkEnabled;
+
+static std::uint32_t GetNetworkFeature(Color perspective, Square kingSquare, Color pieceColor, PieceType piece, Square src)
+{
+    if (perspective == Color::BLACK) {
+        kingSquare = FlipSqY(kingSquare);
+        src = FlipSqY(src);
+    }
+
+    std::uint32_t pieceIndex = 2 * (piece - PieceType::PAWN) + (pieceColor == perspective ? 0 : 1);
+
+    return (kingSquare * NetworkPieceCount + pieceIndex) * Square::SQUARE_COUNT + src;
+}
+
+void AddNetworkFeature(std::int16_t* accumulator, std::uint32_t feature);
+void RemoveNetworkFeature(std::int16_t* accumulator, std::uint32_t feature);
+void ResetNetworkAccumulator(std::int16_t* accumulator);
+
+Score EvaluateNetwork(NetworkAccumulator& accumulator, Color sideToMove);
+Score EvaluateNetworkReference(NetworkAccumulator& accumulator, Color sideToMove);
+
+bool LoadNetwork(const std::string& networkFileName);
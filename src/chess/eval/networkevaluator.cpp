@@ -0,0 +1,61 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cstring>
+
+#include "networkevaluator.h"
+
+#include "network.h"
+
+ChessNetworkEvaluator::ChessNetworkEvaluator()
+{
+
+}
+
+ChessNetworkEvaluator::~ChessNetworkEvaluator()
+{
+
+}
+
+//Debug builds check the incremental accumulators and the vectorized layers against a from-scratch scalar evaluation
+static bool checkNetworkEvaluation(ChessBoard& board, Score result)
+{
+    ChessBoard refreshedBoard = board;
+    refreshedBoard.refreshAccumulators();
+
+    if (std::memcmp(&refreshedBoard.accumulator, &board.accumulator, sizeof(NetworkAccumulator)) != 0) {
+        return false;
+    }
+
+    return result == EvaluateNetworkReference(refreshedBoard.accumulator, board.sideToMove);
+}
+
+Score ChessNetworkEvaluator::evaluateImplementation(ChessBoard& board, Score alpha, Score beta)
+{
+    Score result = EvaluateNetwork(board.accumulator, board.sideToMove);
+
+    assert(checkNetworkEvaluation(board, result));
+
+    return result;
+}
+
+Score ChessNetworkEvaluator::lazyEvaluateImplementation(ChessBoard& board)
+{
+    return EvaluateNetwork(board.accumulator, board.sideToMove);
+}
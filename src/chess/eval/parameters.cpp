@@ -16,18 +16,43 @@
 	along with this program.If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cmath>
+#include <iomanip>
+#include <string>
 
 #include "../../game/personality/parametermap.h"
 
 #include "../../game/types/score.h"
 
 #include "../eval/constructor.h"
+#include "../eval/parameters.h"
 
 #include "../types/piece.h"
 #include "../types/score.h"
 #include "../types/square.h"
 
+std::uint32_t Distance[File::FILE_COUNT][Rank::RANK_COUNT];
+
+static void InitializeDistance()
+{
+	for (Square src = Square::FIRST_SQUARE; src < Square::SQUARE_COUNT; src++) {
+		File file = getFile(src);
+		Rank rank = getRank(src);
+
+		Distance[file][rank] = std::uint32_t(std::sqrt(file * file + rank * rank));
+	}
+}
+
+#ifdef USE_BAKED_PARAMETERS
+//Every table is a constant from bakedparameters.h, so there is nothing left to tune
+ParameterMap chessEngineParameterMap;
+
+void InitializeParameters()
+{
+	InitializeDistance();
+}
+#else
 Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT] = {
 	{ ZERO_SCORE, ZERO_SCORE },
 	{ PAWN_SCORE, PAWN_SCORE },
@@ -42,6 +67,49 @@ Evaluation PiecePairs[PieceType::PIECETYPE_COUNT];
 
 Evaluation LateMoveReductions[4];
 
+//The aspiration window's starting half-width and the percentage it grows by after each failed search.  Like the
+//	reductions, only the mg halves are used.
+Evaluation AspirationWindows[2] = {
+	{ PAWN_SCORE / 8, PAWN_SCORE / 8 },
+	{ 100, 100 }
+};
+
+//Late move pruning skips quiet moves once base + factor * depthLeft^2 of them have been searched, up to a maximum
+//	depthLeft.  History pruning skips quiet moves whose continuation history is below -margin * depthLeft.
+Evaluation LateMovePruning[3] = {
+	{ 3, 3 },
+	{ 2, 2 },
+	{ 3, 3 }
+};
+
+Evaluation HistoryPruning[2] = {
+	{ 2, 2 },
+	{ 2048, 2048 }
+};
+
+//Singular extensions apply from a minimum depthLeft, to hash moves whose entry is at most a few plies shallower than the
+//	node.  The other moves are searched against the hash score less margin * depthLeft.
+Evaluation SingularExtensions[3] = {
+	{ 8, 8 },
+	{ 3, 3 },
+	{ 16, 16 }
+};
+
+//ProbCut applies from a minimum depthLeft.  Captures whose SEE can reach beta + margin are searched that many plies
+//	shallower, against beta + margin.
+Evaluation ProbCut[3] = {
+	{ 5, 5 },
+	{ 4, 4 },
+	{ 160, 160 }
+};
+
+//SEE pruning applies up to a maximum depthLeft, to quiet moves and captures that lose more than margin * depthLeft
+Evaluation SeePruning[3] = {
+	{ 3, 3 },
+	{ 32, 32 },
+	{ 128, 128 }
+};
+
 Evaluation BoardControlPstParameters[Square::SQUARE_COUNT];
 Evaluation KingControlPstParameters[Square::SQUARE_COUNT];
 
@@ -97,7 +165,34 @@ QuadraticConstruct mobilityConstructor[PieceType::PIECETYPE_COUNT];
 QuadraticConstruct safeMobilityConstructor[PieceType::PIECETYPE_COUNT];
 QuadraticConstruct tropismConstructor[PieceType::PIECETYPE_COUNT];
 
-std::uint32_t Distance[File::FILE_COUNT][Rank::RANK_COUNT];
+//The board and evaluators read these copies of the parameters, which are packed when USE_PACKED_EVALUATION is defined
+ChessEvaluation MaterialValues[PieceType::PIECETYPE_COUNT];
+ChessEvaluation PiecePairValues[PieceType::PIECETYPE_COUNT];
+ChessEvaluation PstValues[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
+
+PstPlanes BoardControlMgPlanes;
+PstPlanes BoardControlEgPlanes;
+PstPlanes KingControlMgPlanes;
+PstPlanes KingControlEgPlanes;
+
+ChessEvaluation DoubledRooksValue;
+ChessEvaluation EmptyFileQueenValue;
+ChessEvaluation EmptyFileRookValue;
+ChessEvaluation GoodBishopPawnValues[8];
+ChessEvaluation QueenBehindPassedPawnPstValues[Square::SQUARE_COUNT];
+ChessEvaluation RookBehindPassedPawnPstValues[Square::SQUARE_COUNT];
+
+ChessEvaluation PawnChainBackPstValues[Square::SQUARE_COUNT];
+ChessEvaluation PawnChainFrontPstValues[Square::SQUARE_COUNT];
+ChessEvaluation PawnDoubledPstValues[Square::SQUARE_COUNT];
+ChessEvaluation PawnPassedPstValues[Square::SQUARE_COUNT];
+ChessEvaluation PawnTripledPstValues[Square::SQUARE_COUNT];
+
+ChessEvaluation AttackValues[PieceType::PIECETYPE_COUNT][PieceType::PIECETYPE_COUNT];
+ChessEvaluation BetterMobilityValues[PieceType::PIECETYPE_COUNT][32];
+ChessEvaluation MobilityValues[PieceType::PIECETYPE_COUNT][32];
+ChessEvaluation SafeMobilityValues[PieceType::PIECETYPE_COUNT][32];
+ChessEvaluation TropismValues[PieceType::PIECETYPE_COUNT][16];
 
 ParameterMap chessEngineParameterMap = {
 	{ "material-pawn-mg", &MaterialParameters[PieceType::PAWN].mg },
@@ -351,6 +446,27 @@ ParameterMap chessEngineParameterMap = {
 	{ "search-reductions-searched-moves-mg", &LateMoveReductions[2].mg },
 	{ "search-reductions-all-mg", &LateMoveReductions[3].mg },
 
+	{ "search-aspiration-window-mg", &AspirationWindows[0].mg },
+	{ "search-aspiration-widening-mg", &AspirationWindows[1].mg },
+
+	{ "search-late-move-pruning-base-mg", &LateMovePruning[0].mg },
+	{ "search-late-move-pruning-factor-mg", &LateMovePruning[1].mg },
+	{ "search-late-move-pruning-depth-mg", &LateMovePruning[2].mg },
+	{ "search-history-pruning-depth-mg", &HistoryPruning[0].mg },
+	{ "search-history-pruning-margin-mg", &HistoryPruning[1].mg },
+
+	{ "search-singular-depth-mg", &SingularExtensions[0].mg },
+	{ "search-singular-hash-depth-mg", &SingularExtensions[1].mg },
+	{ "search-singular-margin-mg", &SingularExtensions[2].mg },
+
+	{ "search-probcut-depth-mg", &ProbCut[0].mg },
+	{ "search-probcut-reduction-mg", &ProbCut[1].mg },
+	{ "search-probcut-margin-mg", &ProbCut[2].mg },
+
+	{ "search-see-pruning-depth-mg", &SeePruning[0].mg },
+	{ "search-see-pruning-quiet-margin-mg", &SeePruning[1].mg },
+	{ "search-see-pruning-capture-margin-mg", &SeePruning[2].mg },
+
 	{ "tropism-knight-quadratic-mg", &tropismConstructor[PieceType::KNIGHT].mg.quadratic },
 	{ "tropism-knight-quadratic-eg", &tropismConstructor[PieceType::KNIGHT].eg.quadratic },
 	{ "tropism-knight-slope-mg", &tropismConstructor[PieceType::KNIGHT].mg.slope },
@@ -428,6 +544,41 @@ ParameterMap chessEngineParameterMap = {
 	{ "rook-behind-passed-pawn-file-center-eg", &rookBehindPassedPawnPstConstruct.eg.filecenter },
 };
 
+static void InitializeValues(ChessEvaluation* values, const Evaluation* parameters, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; i++) {
+		values[i] = ToChessEvaluation(parameters[i]);
+	}
+}
+
+static void InitializePstPlanes(PstPlanes& pstPlanes, const Evaluation* pst, Score Evaluation::* phase)
+{
+	Score minimum = pst[Square::FIRST_SQUARE].*phase;
+	Score maximum = minimum;
+
+	for (Square src = Square::FIRST_SQUARE; src < Square::SQUARE_COUNT; src++) {
+		minimum = std::min(minimum, pst[src].*phase);
+		maximum = std::max(maximum, pst[src].*phase);
+	}
+
+	pstPlanes.base = minimum;
+	pstPlanes.planeCount = 0;
+
+	while (pstPlanes.planeCount < 16 && (std::uint32_t(maximum - minimum) >> pstPlanes.planeCount) != 0) {
+		pstPlanes.planeCount++;
+	}
+
+	for (std::uint32_t i = 0; i < pstPlanes.planeCount; i++) {
+		pstPlanes.planes[i] = EmptyBitboard;
+
+		for (Square src = Square::FIRST_SQUARE; src < Square::SQUARE_COUNT; src++) {
+			if (((pst[src].*phase - minimum) >> i) & 1) {
+				pstPlanes.planes[i] |= src;
+			}
+		}
+	}
+}
+
 void InitializeParameters()
 {
 	for (PieceType pieceType = PieceType::PAWN; pieceType < PieceType::PIECETYPE_COUNT; pieceType++) {
@@ -453,10 +604,133 @@ void InitializeParameters()
 	scoreConstructor.construct(pawnPassedPstConstruct, PawnPassedPstParameters, PawnPassedDefault);
 	scoreConstructor.construct(pawnTripledPstConstruct, PawnTripledPstParameters, PawnTripledDefault);
 
-	for (Square src = Square::FIRST_SQUARE; src < Square::SQUARE_COUNT; src++) {
-		File file = getFile(src);
-		Rank rank = getRank(src);
+	InitializeDistance();
+
+	InitializeValues(MaterialValues, MaterialParameters, PieceType::PIECETYPE_COUNT);
+	InitializeValues(PiecePairValues, PiecePairs, PieceType::PIECETYPE_COUNT);
+	InitializeValues(&PstValues[0][0], &PstParameters[0][0], PieceType::PIECETYPE_COUNT * Square::SQUARE_COUNT);
+
+	InitializePstPlanes(BoardControlMgPlanes, BoardControlPstParameters, &Evaluation::mg);
+	InitializePstPlanes(BoardControlEgPlanes, BoardControlPstParameters, &Evaluation::eg);
+	InitializePstPlanes(KingControlMgPlanes, KingControlPstParameters, &Evaluation::mg);
+	InitializePstPlanes(KingControlEgPlanes, KingControlPstParameters, &Evaluation::eg);
+
+	InitializeValues(&DoubledRooksValue, &DoubledRooks, 1);
+	InitializeValues(&EmptyFileQueenValue, &EmptyFileQueen, 1);
+	InitializeValues(&EmptyFileRookValue, &EmptyFileRook, 1);
+	InitializeValues(GoodBishopPawnValues, GoodBishopPawns, 8);
+	InitializeValues(QueenBehindPassedPawnPstValues, QueenBehindPassedPawnPst, Square::SQUARE_COUNT);
+	InitializeValues(RookBehindPassedPawnPstValues, RookBehindPassedPawnPst, Square::SQUARE_COUNT);
+
+	InitializeValues(PawnChainBackPstValues, PawnChainBackPstParameters, Square::SQUARE_COUNT);
+	InitializeValues(PawnChainFrontPstValues, PawnChainFrontPstParameters, Square::SQUARE_COUNT);
+	InitializeValues(PawnDoubledPstValues, PawnDoubledPstParameters, Square::SQUARE_COUNT);
+	InitializeValues(PawnPassedPstValues, PawnPassedPstParameters, Square::SQUARE_COUNT);
+	InitializeValues(PawnTripledPstValues, PawnTripledPstParameters, Square::SQUARE_COUNT);
+
+	InitializeValues(&AttackValues[0][0], &AttackParameters[0][0], PieceType::PIECETYPE_COUNT * PieceType::PIECETYPE_COUNT);
+	InitializeValues(&BetterMobilityValues[0][0], &BetterMobilityParameters[0][0], PieceType::PIECETYPE_COUNT * 32);
+	InitializeValues(&MobilityValues[0][0], &MobilityParameters[0][0], PieceType::PIECETYPE_COUNT * 32);
+	InitializeValues(&SafeMobilityValues[0][0], &SafeMobilityParameters[0][0], PieceType::PIECETYPE_COUNT * 32);
+	InitializeValues(&TropismValues[0][0], &TropismParameters[0][0], PieceType::PIECETYPE_COUNT * 16);
+}
 
-		Distance[file][rank] = std::uint32_t(std::sqrt(file * file + rank * rank));
+static void WriteValue(std::ostream& out, ChessEvaluation value)
+{
+	out << "MakeChessEvaluation(" << GetMg(value) << ", " << GetEg(value) << ")";
+}
+
+//Tables with more than one row are written a row per line in nested braces, single rows are wrapped every 8 values
+static void WriteValues(std::ostream& out, const std::string& declaration, const ChessEvaluation* values, std::size_t rows, std::size_t columns)
+{
+	out << "static constexpr ChessEvaluation " << declaration << " = {" << std::endl;
+
+	for (std::size_t row = 0; row < rows; row++) {
+		out << "\t" << (rows > 1 ? "{ " : "");
+
+		for (std::size_t column = 0; column < columns; column++) {
+			if (column != 0) {
+				out << (rows == 1 && column % 8 == 0 ? ",\n\t" : ", ");
+			}
+
+			WriteValue(out, values[row * columns + column]);
+		}
+
+		out << (rows > 1 ? " }" : "") << (row + 1 < rows ? "," : "") << std::endl;
+	}
+
+	out << "};" << std::endl << std::endl;
+}
+
+static void WriteParameters(std::ostream& out, const std::string& declaration, const Evaluation* parameters, std::size_t size)
+{
+	out << "static constexpr Evaluation " << declaration << " = {" << std::endl;
+
+	for (std::size_t i = 0; i < size; i++) {
+		out << "\t{ " << parameters[i].mg << ", " << parameters[i].eg << " }" << (i + 1 < size ? "," : "") << std::endl;
 	}
+
+	out << "};" << std::endl << std::endl;
+}
+
+static void WritePstPlanes(std::ostream& out, const std::string& name, const PstPlanes& pstPlanes)
+{
+	out << "static constexpr PstPlanes " << name << " = { " << pstPlanes.base << ", " << pstPlanes.planeCount << ", {";
+
+	for (std::uint32_t i = 0; i < pstPlanes.planeCount; i++) {
+		out << (i != 0 ? ", " : " ") << "Bitboard(0x" << std::hex << std::setw(16) << std::setfill('0') << pstPlanes.planes[i] << std::dec << ")";
+	}
+
+	out << " } };" << std::endl;
+}
+
+void WriteBakedParameters(std::ostream& out)
+{
+	out << "//Generated by the \"bake\" command from a personality; rebuild with make build-baked rather than editing it." << std::endl;
+	out << "//\tIncluded by parameters.h when USE_BAKED_PARAMETERS is defined." << std::endl;
+	out << "#pragma once" << std::endl << std::endl;
+
+	WriteParameters(out, "MaterialParameters[PieceType::PIECETYPE_COUNT]", MaterialParameters, PieceType::PIECETYPE_COUNT);
+	WriteParameters(out, "LateMoveReductions[4]", LateMoveReductions, 4);
+	WriteParameters(out, "AspirationWindows[2]", AspirationWindows, 2);
+	WriteParameters(out, "LateMovePruning[3]", LateMovePruning, 3);
+	WriteParameters(out, "HistoryPruning[2]", HistoryPruning, 2);
+	WriteParameters(out, "SingularExtensions[3]", SingularExtensions, 3);
+	WriteParameters(out, "ProbCut[3]", ProbCut, 3);
+	WriteParameters(out, "SeePruning[3]", SeePruning, 3);
+
+	WriteValues(out, "MaterialValues[PieceType::PIECETYPE_COUNT]", MaterialValues, 1, PieceType::PIECETYPE_COUNT);
+	WriteValues(out, "PiecePairValues[PieceType::PIECETYPE_COUNT]", PiecePairValues, 1, PieceType::PIECETYPE_COUNT);
+	WriteValues(out, "PstValues[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT]", &PstValues[0][0], PieceType::PIECETYPE_COUNT, Square::SQUARE_COUNT);
+
+	WritePstPlanes(out, "BoardControlMgPlanes", BoardControlMgPlanes);
+	WritePstPlanes(out, "BoardControlEgPlanes", BoardControlEgPlanes);
+	WritePstPlanes(out, "KingControlMgPlanes", KingControlMgPlanes);
+	WritePstPlanes(out, "KingControlEgPlanes", KingControlEgPlanes);
+	out << std::endl;
+
+	out << "static constexpr ChessEvaluation DoubledRooksValue = ";
+	WriteValue(out, DoubledRooksValue);
+	out << ";" << std::endl << "static constexpr ChessEvaluation EmptyFileQueenValue = ";
+	WriteValue(out, EmptyFileQueenValue);
+	out << ";" << std::endl << "static constexpr ChessEvaluation EmptyFileRookValue = ";
+	WriteValue(out, EmptyFileRookValue);
+	out << ";" << std::endl << std::endl;
+
+	WriteValues(out, "GoodBishopPawnValues[8]", GoodBishopPawnValues, 1, 8);
+	WriteValues(out, "QueenBehindPassedPawnPstValues[Square::SQUARE_COUNT]", QueenBehindPassedPawnPstValues, 1, Square::SQUARE_COUNT);
+	WriteValues(out, "RookBehindPassedPawnPstValues[Square::SQUARE_COUNT]", RookBehindPassedPawnPstValues, 1, Square::SQUARE_COUNT);
+
+	WriteValues(out, "PawnChainBackPstValues[Square::SQUARE_COUNT]", PawnChainBackPstValues, 1, Square::SQUARE_COUNT);
+	WriteValues(out, "PawnChainFrontPstValues[Square::SQUARE_COUNT]", PawnChainFrontPstValues, 1, Square::SQUARE_COUNT);
+	WriteValues(out, "PawnDoubledPstValues[Square::SQUARE_COUNT]", PawnDoubledPstValues, 1, Square::SQUARE_COUNT);
+	WriteValues(out, "PawnPassedPstValues[Square::SQUARE_COUNT]", PawnPassedPstValues, 1, Square::SQUARE_COUNT);
+	WriteValues(out, "PawnTripledPstValues[Square::SQUARE_COUNT]", PawnTripledPstValues, 1, Square::SQUARE_COUNT);
+
+	WriteValues(out, "AttackValues[PieceType::PIECETYPE_COUNT][PieceType::PIECETYPE_COUNT]", &AttackValues[0][0], PieceType::PIECETYPE_COUNT, PieceType::PIECETYPE_COUNT);
+	WriteValues(out, "BetterMobilityValues[PieceType::PIECETYPE_COUNT][32]", &BetterMobilityValues[0][0], PieceType::PIECETYPE_COUNT, 32);
+	WriteValues(out, "MobilityValues[PieceType::PIECETYPE_COUNT][32]", &MobilityValues[0][0], PieceType::PIECETYPE_COUNT, 32);
+	WriteValues(out, "SafeMobilityValues[PieceType::PIECETYPE_COUNT][32]", &SafeMobilityValues[0][0], PieceType::PIECETYPE_COUNT, 32);
+	WriteValues(out, "TropismValues[PieceType::PIECETYPE_COUNT][16]", &TropismValues[0][0], PieceType::PIECETYPE_COUNT, 16);
 }
+#endif
@@ -18,4 +18,81 @@
 
 #pragma once
 
+#include <cstdint>
+#include <ostream>
+
+#include "../../game/math/popcount.h"
+
+#include "../../game/types/bitboard.h"
+#include "../../game/types/score.h"
+
+#include "../types/piece.h"
+#include "../types/score.h"
+#include "../types/square.h"
+
+//A PST split into bit planes: a square's value is base plus the sum of 1 << i for every plane i containing it.  Summing
+//	a PST over a set of squares is then one popcount per plane.
+struct PstPlanes
+{
+	Score base;
+	std::uint32_t planeCount;
+	Bitboard planes[16];
+};
+
+static Score SumPstPlanes(const PstPlanes& pstPlanes, Bitboard squares)
+{
+	Score result = pstPlanes.base * Score(popCount(squares));
+
+	for (std::uint32_t i = 0; i < pstPlanes.planeCount; i++) {
+		result += Score(popCount(squares & pstPlanes.planes[i])) << i;
+	}
+
+	return result;
+}
+
+//USE_BAKED_PARAMETERS swaps the tunable tables for the constants in bakedparameters.h, which the "bake" command writes
+//	from the current personality.  The compiler can then fold them, but setvalue and personality are compiled out.
+#ifdef USE_BAKED_PARAMETERS
+#include "bakedparameters.h"
+#else
+extern Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT];
+extern Evaluation LateMoveReductions[4];
+extern Evaluation AspirationWindows[2];
+extern Evaluation LateMovePruning[3];
+extern Evaluation HistoryPruning[2];
+extern Evaluation SingularExtensions[3];
+extern Evaluation ProbCut[3];
+extern Evaluation SeePruning[3];
+
+extern ChessEvaluation MaterialValues[PieceType::PIECETYPE_COUNT];
+extern ChessEvaluation PiecePairValues[PieceType::PIECETYPE_COUNT];
+extern ChessEvaluation PstValues[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
+
+extern PstPlanes BoardControlMgPlanes;
+extern PstPlanes BoardControlEgPlanes;
+extern PstPlanes KingControlMgPlanes;
+extern PstPlanes KingControlEgPlanes;
+
+extern ChessEvaluation DoubledRooksValue;
+extern ChessEvaluation EmptyFileQueenValue;
+extern ChessEvaluation EmptyFileRookValue;
+extern ChessEvaluation GoodBishopPawnValues[8];
+extern ChessEvaluation QueenBehindPassedPawnPstValues[Square::SQUARE_COUNT];
+extern ChessEvaluation RookBehindPassedPawnPstValues[Square::SQUARE_COUNT];
+
+extern ChessEvaluation PawnChainBackPstValues[Square::SQUARE_COUNT];
+extern ChessEvaluation PawnChainFrontPstValues[Square::SQUARE_COUNT];
+extern ChessEvaluation PawnDoubledPstValues[Square::SQUARE_COUNT];
+extern ChessEvaluation PawnPassedPstValues[Square::SQUARE_COUNT];
+extern ChessEvaluation PawnTripledPstValues[Square::SQUARE_COUNT];
+
+extern ChessEvaluation AttackValues[PieceType::PIECETYPE_COUNT][PieceType::PIECETYPE_COUNT];
+extern ChessEvaluation BetterMobilityValues[PieceType::PIECETYPE_COUNT][32];
+extern ChessEvaluation MobilityValues[PieceType::PIECETYPE_COUNT][32];
+extern ChessEvaluation SafeMobilityValues[PieceType::PIECETYPE_COUNT][32];
+extern ChessEvaluation TropismValues[PieceType::PIECETYPE_COUNT][16];
+
+void WriteBakedParameters(std::ostream& out);
+#endif
+
 void InitializeParameters();
@@ -20,26 +20,16 @@
 #include <cstdint>
 
 #include "pawnevaluator.h"
+#include "parameters.h"
+
+#include "../types/bitboard.h"
 
 #include "../../game/math/bitreset.h"
 #include "../../game/math/bitscan.h"
-#include "../../game/math/byteswap.h"
 #include "../../game/math/popcount.h"
 
 extern Bitboard bbFile[File::FILE_COUNT];
 
-extern Bitboard BlackPawnCaptures[Square::SQUARE_COUNT];
-extern Bitboard WhitePawnCaptures[Square::SQUARE_COUNT];
-
-extern Evaluation PawnChainBackPstParameters[Square::SQUARE_COUNT];
-extern Evaluation PawnChainFrontPstParameters[Square::SQUARE_COUNT];
-extern Evaluation PawnDoubledPstParameters[Square::SQUARE_COUNT];
-extern Evaluation PawnPassedPstParameters[Square::SQUARE_COUNT];
-extern Evaluation PawnTripledPstParameters[Square::SQUARE_COUNT];
-
-extern Bitboard PassedPawnCheck[Square::SQUARE_COUNT];
-extern Bitboard SquaresInFront[Square::SQUARE_COUNT];
-
 ChessPawnEvaluator::ChessPawnEvaluator()
 {
 
@@ -50,130 +40,89 @@ ChessPawnEvaluator::~ChessPawnEvaluator()
 
 }
 
-Score ChessPawnEvaluator::evaluateImplementation(ChessBoard& board, Score alpha, Score beta)
+//Sum the PST values of a set of squares, seen from white's side of the board
+static ChessEvaluation evaluatePawnSquares(const ChessEvaluation* pst, Bitboard squares, bool colorIsWhite)
 {
-	constexpr Rank lastRank = Rank::_8;
+	ChessEvaluation result = ZeroChessEvaluation;
 
-	Evaluation evaluation = { ZERO_SCORE, ZERO_SCORE };
+	Square src;
+	while (BitScanForward64((std::uint32_t*) & src, squares)) {
+		squares = ResetLowestSetBit(squares);
 
-	this->evaluatePawnChain(evaluation, board);
-
-	for (Color color = Color::COLOR_START; color < Color::COLOR_COUNT; color++) {
-		bool colorIsWhite = color == Color::WHITE;
-		int multiplier = colorIsWhite ? 1 : -1;
+		result += pst[colorIsWhite ? src : FlipSqY(src)];
+	}
 
-		Bitboard* colorPieces = colorIsWhite ? board.whitePieces : board.blackPieces;
-		Bitboard* otherPieces = colorIsWhite ? board.blackPieces : board.whitePieces;
+	return result;
+}
 
-		Bitboard colorPawns = colorPieces[PieceType::PAWN];
-		Bitboard otherPawns = otherPieces[PieceType::PAWN];
+Score ChessPawnEvaluator::evaluateImplementation(ChessBoard& board, Score alpha, Score beta)
+{
+	ChessEvaluation evaluation = ZeroChessEvaluation;
 
-		Bitboard passedPawns = EmptyBitboard;
+	this->evaluatePawnChain(evaluation, board);
 
-		Square src;
-		Bitboard loopingPawns = colorPawns;
-		while (BitScanForward64((std::uint32_t*) & src, loopingPawns)) {
-			loopingPawns = ResetLowestSetBit(loopingPawns);
+	Bitboard whitePawns = board.whitePieces[PieceType::PAWN];
+	Bitboard blackPawns = board.blackPieces[PieceType::PAWN];
 
-			Square evaluatedSquare = colorIsWhite ? src : FlipSqY(src);
+	//1) Fill each side's pawns forward and backward.  A span excludes the pawn itself.
+	Bitboard whiteFrontSpan = FillUp(whitePawns) >> 8;
+	Bitboard whiteRearSpan = FillDown(whitePawns) << 8;
+	Bitboard blackFrontSpan = FillDown(blackPawns) << 8;
+	Bitboard blackRearSpan = FillUp(blackPawns) >> 8;
 
-			File evaluatedSrcFile = getFile(evaluatedSquare);
-			Rank evaluatedSrcRank = getRank(evaluatedSquare);
+	for (Color color = Color::COLOR_START; color < Color::COLOR_COUNT; color++) {
+		bool colorIsWhite = color == Color::WHITE;
+		int multiplier = colorIsWhite ? 1 : -1;
 
-			Bitboard evaluatedColorPawns = colorIsWhite ? colorPawns : SwapBytes(colorPawns);
-			Bitboard evaluatedOtherPawns = colorIsWhite ? otherPawns : SwapBytes(otherPawns);
+		Bitboard colorPawns = colorIsWhite ? whitePawns : blackPawns;
+		Bitboard otherFrontSpan = colorIsWhite ? blackFrontSpan : whiteFrontSpan;
 
-			bool passed = false;
+		//2) A pawn is passed if no enemy pawn's front span covers its file or a neighboring file
+		Bitboard blockedSquares = otherFrontSpan
+			| ((otherFrontSpan & ~bbFile[File::_A]) + Direction::LEFT)
+			| ((otherFrontSpan & ~bbFile[File::_H]) + Direction::RIGHT);
 
-			if (((PassedPawnCheck[evaluatedSquare] & evaluatedOtherPawns) == EmptyBitboard)) {
-				passed = true;
+		Bitboard passedPawns = colorPawns & ~blockedSquares;
 
-				passedPawns |= src;
+		//3) A pawn is doubled if it is in the rear span of its own pawns, and tripled if it is in the rear span of those
+		Bitboard doubledPawns = colorPawns & (colorIsWhite ? whiteRearSpan : blackRearSpan);
+		Bitboard tripledPawns = colorPawns & (colorIsWhite ? FillDown(doubledPawns) << 8 : FillUp(doubledPawns) >> 8);
 
-				//2b) The pawn is unstoppable if it's closer to the back rank than the enemy king is to the pawn
-				//if (Distance(evaluatedSrcRank, lastRank) < Distance(evaluatedSrcFile, getFile(otherKingPosition))) {
-				//	evaluation += multiplier * UnstoppablePawnValues[evaluatedSquare];
-				//}
-				//else {
-					evaluation += multiplier * PawnPassedPstParameters[evaluatedSquare];
-				//}
-			}
+		doubledPawns &= ~tripledPawns;
 
-			Bitboard pawnsInFrontOfSrc = SquaresInFront[evaluatedSquare] & evaluatedColorPawns;
-			if (pawnsInFrontOfSrc != EmptyBitboard) {
-				if (popCountIsOne(pawnsInFrontOfSrc)) {
-					evaluation += multiplier * PawnDoubledPstParameters[evaluatedSquare];
-				}
-				else {
-					evaluation += multiplier * PawnTripledPstParameters[evaluatedSquare];
-				}
-			}
-		}
+		evaluation += multiplier * evaluatePawnSquares(PawnPassedPstValues, passedPawns, colorIsWhite);
+		evaluation += multiplier * evaluatePawnSquares(PawnDoubledPstValues, doubledPawns, colorIsWhite);
+		evaluation += multiplier * evaluatePawnSquares(PawnTripledPstValues, tripledPawns, colorIsWhite);
 
 		this->passedPawns[color] = passedPawns;
 	}
 
-	std::int32_t pieceCount = popCount(board.allPieces);
-	Score result = ((evaluation.mg * pieceCount) + (evaluation.eg * (32 - pieceCount))) / 32;
+	Score result = TaperEvaluation(evaluation, board.pieceCount);
 
 	bool whiteToMove = board.sideToMove == Color::WHITE;
 	return whiteToMove ? result : -result;
 }
 
-void ChessPawnEvaluator::evaluatePawnChain(Evaluation& evaluation, ChessBoard& board)
+void ChessPawnEvaluator::evaluatePawnChain(ChessEvaluation& evaluation, ChessBoard& board)
 {
 	Bitboard whitePawns = board.whitePieces[PieceType::PAWN];
 	Bitboard blackPawns = board.blackPieces[PieceType::PAWN];
 
-	Bitboard upLeft = (whitePawns & ~bbFile[File::_A]) >> (-Direction::UP_LEFT);
-	Bitboard upRight = (whitePawns & ~bbFile[File::_H]) >> (-Direction::UP_RIGHT);
-
-	Bitboard whitePawnChains = (upLeft | upRight) & whitePawns;
-
-	while (whitePawnChains != EmptyBitboard) {
-		Square dst;
-		
-		BitScanForward64((std::uint32_t*)& dst, whitePawnChains);
-		whitePawnChains = ResetLowestSetBit(whitePawnChains);
-
-		evaluation += PawnChainFrontPstParameters[dst];
-
-		Bitboard backChainPawns = BlackPawnCaptures[dst] & whitePawns;
-		while (backChainPawns != EmptyBitboard) {
-			Square src;
-
-			BitScanForward64((std::uint32_t*) & src, backChainPawns);
-			backChainPawns = ResetLowestSetBit(backChainPawns);
+	//1) The front of a chain is a pawn defended by another pawn.  Each defender is the back of the chain once per
+	//	pawn it defends, so the two diagonals are kept apart.
+	Bitboard whiteLeftFronts = ((whitePawns & ~bbFile[File::_A]) + Direction::UP_LEFT) & whitePawns;
+	Bitboard whiteRightFronts = ((whitePawns & ~bbFile[File::_H]) + Direction::UP_RIGHT) & whitePawns;
 
-			evaluation += PawnChainBackPstParameters[src];
-		}
-	}
-
-	Bitboard downLeft = (blackPawns & ~bbFile[File::_A]) << Direction::DOWN_LEFT;
-	Bitboard downRight = (blackPawns & ~bbFile[File::_H]) << Direction::DOWN_RIGHT;
-
-	Bitboard blackPawnChains = (downLeft | downRight) & blackPawns;
-
-	while (blackPawnChains != EmptyBitboard) {
-		Square dst;
+	evaluation += evaluatePawnSquares(PawnChainFrontPstValues, whiteLeftFronts | whiteRightFronts, true);
+	evaluation += evaluatePawnSquares(PawnChainBackPstValues, whiteLeftFronts + Direction::DOWN_RIGHT, true);
+	evaluation += evaluatePawnSquares(PawnChainBackPstValues, whiteRightFronts + Direction::DOWN_LEFT, true);
 
-		BitScanForward64((std::uint32_t*)& dst, blackPawnChains);
-		blackPawnChains = ResetLowestSetBit(blackPawnChains);
+	Bitboard blackLeftFronts = ((blackPawns & ~bbFile[File::_A]) + Direction::DOWN_LEFT) & blackPawns;
+	Bitboard blackRightFronts = ((blackPawns & ~bbFile[File::_H]) + Direction::DOWN_RIGHT) & blackPawns;
 
-		dst = FlipSqY(dst);
-		evaluation -= PawnChainFrontPstParameters[dst];
-
-		Bitboard backChainPawns = WhitePawnCaptures[dst] & blackPawns;
-		while (backChainPawns != EmptyBitboard) {
-			Square src;
-
-			BitScanForward64((std::uint32_t*) & src, backChainPawns);
-			backChainPawns = ResetLowestSetBit(backChainPawns);
-
-			src = FlipSqY(src);
-			evaluation -= PawnChainBackPstParameters[src];
-		}
-	}
+	evaluation -= evaluatePawnSquares(PawnChainFrontPstValues, blackLeftFronts | blackRightFronts, false);
+	evaluation -= evaluatePawnSquares(PawnChainBackPstValues, blackLeftFronts + Direction::UP_RIGHT, false);
+	evaluation -= evaluatePawnSquares(PawnChainBackPstValues, blackRightFronts + Direction::UP_LEFT, false);
 }
 
 Bitboard ChessPawnEvaluator::getPassedPawns(Color color)
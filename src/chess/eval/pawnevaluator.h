@@ -27,7 +27,7 @@ class ChessPawnEvaluator : public Evaluator<ChessPawnEvaluator, ChessBoard>
 protected:
 	Bitboard passedPawns[Color::COLOR_COUNT];
 
-	void evaluatePawnChain(Evaluation& evaluation, ChessBoard& board);
+	void evaluatePawnChain(ChessEvaluation& evaluation, ChessBoard& board);
 public:
     ChessPawnEvaluator();
     ~ChessPawnEvaluator();
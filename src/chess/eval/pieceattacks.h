@@ -0,0 +1,148 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#ifdef USE_M128I
+#include <emmintrin.h>
+#endif
+
+#include "../../game/types/bitboard.h"
+
+#include "../types/square.h"
+
+//Set-wise attack generation: every piece of a type is handled in the same pass, so the result is the union of their
+//  attacks.  Sliders use Kogge-Stone occluded fills, which only shift, and and or, so the same code runs on a Bitboard
+//  or on an __m128i holding both sides in its two lanes.
+static constexpr Bitboard NotFileA = Bitboard(0xfefefefefefefefe);
+static constexpr Bitboard NotFileAB = Bitboard(0xfcfcfcfcfcfcfcfc);
+static constexpr Bitboard NotFileH = Bitboard(0x7f7f7f7f7f7f7f7f);
+static constexpr Bitboard NotFileGH = Bitboard(0x3f3f3f3f3f3f3f3f);
+
+//Squares a piece may land on after stepping in a direction, so that steps to the right cannot wrap onto file A, etc.
+template<int fileStep>
+static constexpr Bitboard NoWrapMask()
+{
+    return fileStep > 1 ? NotFileAB : fileStep == 1 ? NotFileA : fileStep == -1 ? NotFileH : fileStep < -1 ? NotFileGH : ~EmptyBitboard;
+}
+
+template<int shift>
+static inline Bitboard ShiftSet(Bitboard b)
+{
+    if constexpr (shift > 0) {
+        return b << shift;
+    }
+    else {
+        return b >> -shift;
+    }
+}
+
+static inline Bitboard MaskSet(Bitboard b, Bitboard mask)
+{
+    return b & mask;
+}
+
+static inline Bitboard AndSet(Bitboard a, Bitboard b)
+{
+    return a & b;
+}
+
+static inline Bitboard OrSet(Bitboard a, Bitboard b)
+{
+    return a | b;
+}
+
+#ifdef USE_M128I
+template<int shift>
+static inline __m128i ShiftSet(__m128i b)
+{
+    if constexpr (shift > 0) {
+        return _mm_slli_epi64(b, shift);
+    }
+    else {
+        return _mm_srli_epi64(b, -shift);
+    }
+}
+
+static inline __m128i MaskSet(__m128i b, Bitboard mask)
+{
+    return _mm_and_si128(b, _mm_set1_epi64x(mask));
+}
+
+static inline __m128i AndSet(__m128i a, __m128i b)
+{
+    return _mm_and_si128(a, b);
+}
+
+static inline __m128i OrSet(__m128i a, __m128i b)
+{
+    return _mm_or_si128(a, b);
+}
+#endif
+
+//Slide every piece in sliders one direction until it is blocked, then step once more onto the blocker.  Empty squares
+//  that would wrap around the board edge are removed from the propagator before filling.
+template<int rankStep, int fileStep, typename SetType>
+static inline SetType OccludedFillAttacks(SetType sliders, SetType empty)
+{
+    constexpr int shift = rankStep * Direction::ONE_RANK + fileStep * Direction::ONE_FILE;
+    constexpr Bitboard mask = NoWrapMask<fileStep>();
+
+    //1) Fill 1, 2 and 4 squares at a time, shrinking the propagator as it goes
+    SetType propagator = MaskSet(empty, mask);
+
+    sliders = OrSet(sliders, AndSet(propagator, ShiftSet<shift>(sliders)));
+    propagator = AndSet(propagator, ShiftSet<shift>(propagator));
+    sliders = OrSet(sliders, AndSet(propagator, ShiftSet<2 * shift>(sliders)));
+    propagator = AndSet(propagator, ShiftSet<2 * shift>(propagator));
+    sliders = OrSet(sliders, AndSet(propagator, ShiftSet<4 * shift>(sliders)));
+
+    //2) The filled squares attack one square further, including the blocker
+    return MaskSet(ShiftSet<shift>(sliders), mask);
+}
+
+template<typename SetType>
+static inline SetType BishopSetAttacks(SetType bishops, SetType empty)
+{
+    return OrSet(OrSet(OccludedFillAttacks<-1, -1>(bishops, empty), OccludedFillAttacks<-1, 1>(bishops, empty)),
+        OrSet(OccludedFillAttacks<1, -1>(bishops, empty), OccludedFillAttacks<1, 1>(bishops, empty)));
+}
+
+template<typename SetType>
+static inline SetType RookSetAttacks(SetType rooks, SetType empty)
+{
+    return OrSet(OrSet(OccludedFillAttacks<-1, 0>(rooks, empty), OccludedFillAttacks<1, 0>(rooks, empty)),
+        OrSet(OccludedFillAttacks<0, -1>(rooks, empty), OccludedFillAttacks<0, 1>(rooks, empty)));
+}
+
+template<int rankStep, int fileStep, typename SetType>
+static inline SetType StepAttacks(SetType pieces)
+{
+    constexpr int shift = rankStep * Direction::ONE_RANK + fileStep * Direction::ONE_FILE;
+
+    return MaskSet(ShiftSet<shift>(pieces), NoWrapMask<fileStep>());
+}
+
+template<typename SetType>
+static inline SetType KnightSetAttacks(SetType knights)
+{
+    return OrSet(OrSet(OrSet(StepAttacks<-2, -1>(knights), StepAttacks<-2, 1>(knights)),
+            OrSet(StepAttacks<-1, -2>(knights), StepAttacks<-1, 2>(knights))),
+        OrSet(OrSet(StepAttacks<1, -2>(knights), StepAttacks<1, 2>(knights)),
+            OrSet(StepAttacks<2, -1>(knights), StepAttacks<2, 1>(knights))));
+}
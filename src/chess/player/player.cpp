@@ -51,6 +51,8 @@ void ChessPlayer::applyPersonalityImplementation(bool strip)
     board.materialEvaluation = board.calculateMaterialEvaluation();
     board.pstEvaluation = board.calculatePstEvaluation();
 
+    //The lazy evaluation margins were measured with the old parameters
+    this->resetStageMargins();
 }
 
 TwoPlayerGameResult ChessPlayer::checkBoardGameResultImplementation(BoardType& board)
@@ -63,6 +65,11 @@ void ChessPlayer::getMoveImplementation(MoveType& move)
     BoardType board = this->getCurrentBoard();
     ChessPrincipalVariation principalVariation;
 
+    //The game history may have been played before a network was loaded
+    if (NetworkEnabled) {
+        board.refreshAccumulators();
+    }
+
     this->searcher.setClock(this->clock);
 
     this->searcher.iterativeDeepeningLoop(board, principalVariation);
@@ -76,7 +83,17 @@ NodeCount ChessPlayer::perft(Depth depth)
     return this->moveGenerator.perft(board, depth, Depth::ONE);
 }
 
+void ChessPlayer::printEvaluationStatistics()
+{
+    this->searcher.printEvaluationStatistics();
+}
+
 void ChessPlayer::resetHashtable()
 {
     this->searcher.resetHashtable();
 }
+
+void ChessPlayer::resetStageMargins()
+{
+    this->searcher.resetStageMargins();
+}
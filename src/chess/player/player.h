@@ -49,5 +49,8 @@ public:
     void getMoveImplementation(MoveType& move);
     NodeCount perft(Depth depth);
 
+    void printEvaluationStatistics();
+
     void resetHashtable();
+    void resetStageMargins();
 };
@@ -18,9 +18,35 @@
 
 #pragma once
 
-#include "../../game/search/butterfly.h"
+#include <cstdint>
+#include <cstring>
+
+#include "continuation.h"
+
+#include "../../game/types/color.h"
 
 #include "../types/piece.h"
 #include "../types/square.h"
 
-typedef ButterflyTable<PieceType::PIECETYPE_COUNT, Square::SQUARE_COUNT> ChessButterflyTable;
+//History of quiet moves by [piece][dst] for each side, whatever came before them.  Updated with the same bonuses and
+//  gravity as the continuation histories, so the scores can be added together.
+class ChessButterflyTable
+{
+protected:
+    PieceSquareHistory tables[Color::COLOR_COUNT];
+public:
+    ChessButterflyTable()
+    {
+        this->reset();
+    }
+
+    std::int16_t& get(Color color, PieceType piece, Square dst)
+    {
+        return this->tables[color][piece][dst];
+    }
+
+    void reset()
+    {
+        std::memset(this->tables, 0, sizeof(this->tables));
+    }
+};
@@ -0,0 +1,50 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "continuation.h"
+
+#include "../types/piece.h"
+#include "../types/square.h"
+
+//How well each capture has done, indexed by the moving piece, its destination and the captured piece.  Updated with the
+//  same bonuses and gravity as the continuation histories.
+class ChessCaptureHistory
+{
+protected:
+    std::int16_t table[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT][PieceType::PIECETYPE_COUNT];
+public:
+    ChessCaptureHistory()
+    {
+        this->reset();
+    }
+
+    std::int16_t& get(PieceType movingPiece, Square dst, PieceType capturedPiece)
+    {
+        return this->table[movingPiece][dst][capturedPiece];
+    }
+
+    void reset()
+    {
+        std::memset(this->table, 0, sizeof(this->table));
+    }
+};
@@ -0,0 +1,95 @@
+/*
+    Jing Wei, the rebirth of the chess engine I started in 2010
+    Copyright(C) 2019-2020 Chris Florin
+
+    This program is free software : you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "../../game/types/color.h"
+#include "../../game/types/depth.h"
+
+#include "../types/move.h"
+#include "../types/piece.h"
+#include "../types/square.h"
+
+//History scores stay within +/-HistoryMaximum.  Updates use "gravity": a bonus moves an entry less the closer it already
+//  is to the limit, so scores saturate instead of overflowing and old results decay as new ones come in.
+static constexpr std::int32_t HistoryMaximum = 16384;
+
+typedef std::int16_t PieceSquareHistory[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
+
+static std::int32_t GetHistoryBonus(Depth depthLeft)
+{
+    return std::min(32 * std::int32_t(depthLeft) * std::int32_t(depthLeft), 2048);
+}
+
+static void UpdateHistory(std::int16_t& entry, std::int32_t bonus)
+{
+    entry += std::int16_t(bonus - std::int32_t(entry) * std::abs(bonus) / HistoryMaximum);
+}
+
+//The quiet move that last refuted each move, indexed by the side to move and the piece and destination of the previous move
+class ChessCounterMoveTable
+{
+protected:
+    ChessMove moves[Color::COLOR_COUNT][PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
+public:
+    ChessCounterMoveTable()
+    {
+        this->reset();
+    }
+
+    ChessMove& get(Color color, PieceType previousPiece, Square previousDst)
+    {
+        return this->moves[color][previousPiece][previousDst];
+    }
+
+    void reset()
+    {
+        std::fill(&this->moves[0][0][0], &this->moves[0][0][0] + sizeof(this->moves) / sizeof(ChessMove), ChessMove());
+    }
+};
+
+//History of [piece][dst] following an earlier move, indexed by the side to move and the piece and destination of that
+//  earlier move.  At 800KB it lives on the heap rather than inside the searcher.
+class ChessContinuationHistory
+{
+protected:
+    static constexpr std::size_t TableCount = Color::COLOR_COUNT * PieceType::PIECETYPE_COUNT * Square::SQUARE_COUNT;
+
+    std::unique_ptr<PieceSquareHistory[]> tables;
+public:
+    ChessContinuationHistory() : tables(new PieceSquareHistory[TableCount])
+    {
+        this->reset();
+    }
+
+    PieceSquareHistory& get(Color color, PieceType previousPiece, Square previousDst)
+    {
+        return this->tables[(color * PieceType::PIECETYPE_COUNT + previousPiece) * Square::SQUARE_COUNT + previousDst];
+    }
+
+    void reset()
+    {
+        std::memset(this->tables.get(), 0, TableCount * sizeof(PieceSquareHistory));
+    }
+};
@@ -24,32 +24,93 @@
 
 #include "searcher.h"
 
+#include "../endgame/bitbase.h"
+#include "../endgame/wdl.h"
+#include "../eval/parameters.h"
+
 #include "../types/score.h"
 
 #include "../../game/math/bitreset.h"
 #include "../../game/math/bitscan.h"
 #include "../../game/math/sort.h"
 
+static constexpr bool enableAspirationWindows = enableAllSearchFeatures && true;
 static constexpr bool enableButterflyTable = enableAllSearchFeatures && true;
+static constexpr bool enableCaptureHistory = enableAllSearchFeatures && true;
+static constexpr bool enableContinuationHistory = enableAllSearchFeatures && true;
+static constexpr bool enableCounterMoves = enableAllSearchFeatures && true;
 static constexpr bool enableFutilityPruning = enableAllSearchFeatures && true;
 static constexpr bool enableSearchExtensions = enableAllSearchFeatures && true;
+static constexpr bool enableSingularExtensions = enableAllSearchFeatures && true;
 static constexpr bool enableSearchHashtable = enableAllSearchFeatures && true;
 static constexpr bool enableSearchReductions = enableAllSearchFeatures && true;
+static constexpr bool enableSeePruning = enableAllSearchFeatures && true;
+static constexpr bool enableHistoryPruning = enableAllSearchFeatures && true;
 static constexpr bool enableIID = enableAllSearchFeatures && true;
+static constexpr bool enableLateMovePruning = enableAllSearchFeatures && true;
 static constexpr bool enableMateDistancePruning = enableAllSearchFeatures && true;
 static constexpr bool enableNullMove = enableAllSearchFeatures && true;
+static constexpr bool enableProbCut = enableAllSearchFeatures && true;
+static constexpr bool enableQuiescenceChecks = enableAllSearchFeatures && true;
 static constexpr bool enableQuiescenceEarlyExit = enableAllSearchFeatures && true;
 static constexpr bool enableQuiscenceSearchHashtable = enableAllSearchFeatures && false;
 static constexpr bool enableQuiescenceStaticExchangeEvaluation = enableAllSearchFeatures && true;
 
+static constexpr Depth aspirationWindowMinimumDepth = Depth::FOUR;
+
+//The hashtable only has a byte to spare for the move, so it stores 1 + the move's rank among the position's moves ordered by
+//  src, dst and promotion piece.  0 means there is no move.
+static std::uint32_t GetHashMoveKey(ChessMove& move)
+{
+    return (std::uint32_t(move.src) << 9) | (std::uint32_t(move.dst) << 3) | std::uint32_t(move.promotionPiece);
+}
+
+static std::uint8_t EncodeHashMove(MoveList<ChessMove>& moveList, ChessMove& move)
+{
+    std::uint32_t key = GetHashMoveKey(move);
+    std::uint8_t rank = 1;
+
+    for (MoveList<ChessMove>::iterator it = moveList.begin(); it != moveList.end(); ++it) {
+        if (GetHashMoveKey(*it) < key) {
+            rank++;
+        }
+    }
+
+    return rank;
+}
+
+static bool DecodeHashMove(MoveList<ChessMove>& moveList, std::uint8_t rank, ChessMove& move)
+{
+    std::uint32_t keys[256];
+    std::size_t moveCount = moveList.size();
+
+    //A rank past the end of the list comes from a hash collision
+    if (rank == 0 || rank > moveCount) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < moveCount; i++) {
+        keys[i] = GetHashMoveKey(moveList[i]);
+    }
+
+    std::nth_element(keys, keys + rank - 1, keys + moveCount);
+
+    for (MoveList<ChessMove>::iterator it = moveList.begin(); it != moveList.end(); ++it) {
+        if (GetHashMoveKey(*it) == keys[rank - 1]) {
+            move = *it;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
 extern Bitboard BlackPawnCaptures[Square::SQUARE_COUNT];
 extern Bitboard InBetween[Square::SQUARE_COUNT][Square::SQUARE_COUNT];
 extern Bitboard PieceMoves[PieceType::PIECETYPE_COUNT][Square::SQUARE_COUNT];
 extern Bitboard WhitePawnCaptures[Square::SQUARE_COUNT];
 
-extern Evaluation MaterialParameters[PieceType::PIECETYPE_COUNT];
-extern Evaluation LateMoveReductions[4];
-
 ChessSearcher::ChessSearcher()
 {
     if (enableSearchHashtable) {
@@ -57,6 +118,9 @@ ChessSearcher::ChessSearcher()
     }
 
     this->moveHistory.reserve(4096);
+
+    this->betaCutoffCount = ZeroNodes;
+    this->firstMoveBetaCutoffCount = ZeroNodes;
 }
 
 ChessSearcher::~ChessSearcher()
@@ -104,17 +168,21 @@ TwoPlayerGameResult ChessSearcher::checkBoardGameResult(BoardType& board, ChessM
 template <NodeType nodeType>
 HashtableEntryType ChessSearcher::checkHashtable(BoardType& board, Score& hashScore, Depth depthLeft, Depth currentDepth)
 {
-    HashtableEntryType hashtableEntryType = HASHENTRYTYPE_NONE;
-    Depth hashDepthLeft;
-    std::uint8_t custom;
+    SearchStack& searchStack = this->searchStack[currentDepth];
 
-    if (nodeType != NodeType::PV_NODETYPE) {
-        hashtableEntryType = this->hashtable.search(board.hashValue, hashScore, currentDepth, hashDepthLeft, custom);
+    //PV nodes don't take cutoffs from the hashtable, but still record the entry for its move and singular extensions
+    searchStack.hashEntryType = this->hashtable.search(board.hashValue, searchStack.hashScore, currentDepth, searchStack.hashDepthLeft, searchStack.hashMoveRank);
 
-        if (hashtableEntryType != HASHENTRYTYPE_NONE
-            && hashDepthLeft >= depthLeft) {
-            return hashtableEntryType;
-        }
+    if (searchStack.hashEntryType == HASHENTRYTYPE_NONE) {
+        searchStack.hashMoveRank = 0;
+    }
+
+    if (nodeType != NodeType::PV_NODETYPE
+        && searchStack.hashEntryType != HASHENTRYTYPE_NONE
+        && searchStack.hashDepthLeft >= depthLeft) {
+        hashScore = searchStack.hashScore;
+
+        return searchStack.hashEntryType;
     }
 
     return HASHENTRYTYPE_NONE;
@@ -122,15 +190,17 @@ HashtableEntryType ChessSearcher::checkHashtable(BoardType& board, Score& hashSc
 
 void ChessSearcher::initializeSearchImplementation(BoardType& board)
 {
-    if (enableButterflyTable) {
-        this->butterflyTable.reset();
-    }
-
     this->hashtable.incrementAge();
 
+    for (SearchStack& searchStack : this->searchStack) {
+        searchStack.excludedMove = MoveType();
+        searchStack.hashMove = MoveType();
+    }
+
     this->moveGenerator.generateAllMoves(board, this->rootMoveList);
 
     this->nodeCount = ZeroNodes;
+    this->previousIterationScore = DRAW_SCORE;
 }
 
 template <NodeType nodeType>
@@ -189,10 +259,17 @@ Score ChessSearcher::quiescenceSearch(BoardType& board, Score alpha, Score beta,
         }
     }
 
-    //5) Generate Moves.  Return if Checkmate.
+    //5) Generate Moves.  Return if Checkmate.  On the first ply, quiet checks follow the captures.
     SearchStack& searchStack = this->searchStack[currentDepth];
     MoveList<MoveType>& moveList = searchStack.moveList;
     NodeCount moveCount = this->moveGenerator.generateAllCaptures(board, moveList);
+    NodeCount captureCount = moveCount;
+
+    if (enableQuiescenceChecks
+        && !isInCheck
+        && currentDepth == maxDepth) {
+        moveCount = this->moveGenerator.generateQuietChecks(board, moveList);
+    }
 
     if (moveCount == ZeroNodes) {
         if (isInCheck) {
@@ -202,12 +279,17 @@ Score ChessSearcher::quiescenceSearch(BoardType& board, Score alpha, Score beta,
         return staticScore;
     }
 
-    //6) Attempt to reorder moves to improve the probability of finding the best move first
+    //6) Attempt to reorder moves to improve the probability of finding the best move first.  Captures are already generated in MVV/LVA order.
+    //	Evasions are the whole list when in check, so sorting them leaves captureCount intact.  Quiescence nodes have no PV or
+    //	hash move, and the counter move and continuation histories have to follow this node's previous moves.
     if (isInCheck) {
-        this->moveGenerator.reorderMoves<nodeType>(board, moveList, searchStack, this->butterflyTable);
-    }
-    else {
-        this->moveGenerator.reorderQuiescenceMoves<nodeType>(board, moveList, searchStack);
+        searchStack.principalVariation.clear();
+        searchStack.hashMove = MoveType();
+        this->prepareMoveOrdering(board, currentDepth);
+
+        this->moveGenerator.reorderMoves<nodeType>(board, moveList, searchStack, this->butterflyTable, this->captureHistory);
+
+        std::stable_sort(moveList.begin(), moveList.end(), greater<MoveType>);
     }
 
     //7) MoveList loop
@@ -221,26 +303,35 @@ Score ChessSearcher::quiescenceSearch(BoardType& board, Score alpha, Score beta,
         Square dst = move.dst;
 
         PieceType capturedPiece = board.pieces[dst];
+        bool isQuietCheck = NodeCount(it - moveList.begin()) >= captureCount;
 
-        //8) If capturing this piece won't bring us close to alpha, skip the capture
+        //8) If capturing this piece won't bring us close to alpha, skip the capture.  Captures come in order of victim value,
+        //	so none of the remaining captures will either; move on to the quiet checks.
         if (enableQuiescenceEarlyExit
-            && !isInCheck) {
+            && !isInCheck
+            && !isQuietCheck) {
+            //The only capture onto an empty square is en passant
+            if (capturedPiece == PieceType::NO_PIECE) {
+                capturedPiece = PieceType::PAWN;
+            }
+
             Score capturedPieceScore = MaterialParameters[capturedPiece].mg;
             Score lazyScore = staticScore + capturedPieceScore;
 
             constexpr Score earlyExitThreshold = Score(2 * PAWN_SCORE);
 
             if (lazyScore + earlyExitThreshold < alpha) {
+                it = moveList.begin() + (captureCount - 1);
                 continue;
             }
         }
 
-        //9) Static Exchange Evaluation
-        constexpr Score staticExchangeEvaluationExitThreshold = Score(1 * PAWN_SCORE);
+        //9) Static Exchange Evaluation.  Quiet checks only need to be safe.
+        Score staticExchangeEvaluationExitThreshold = isQuietCheck ? ZERO_SCORE : Score(1 * PAWN_SCORE);
 
         if (enableQuiescenceStaticExchangeEvaluation
             && !isInCheck
-            && (this->staticExchangeEvaluation(board, src, dst) < staticExchangeEvaluationExitThreshold)) {
+            && !this->attackGenerator.seeGreaterOrEqual(board, move, staticExchangeEvaluationExitThreshold)) {
             continue;
         }
 
@@ -248,6 +339,8 @@ Score ChessSearcher::quiescenceSearch(BoardType& board, Score alpha, Score beta,
         BoardType nextBoard = board;
         nextBoard.doMove(move);
 
+        searchStack.currentMove = move;
+
         //11) Recurse to next depth
         Score nextScore;
 
@@ -309,16 +402,144 @@ Score ChessSearcher::quiescenceSearch(BoardType& board, Score alpha, Score beta,
     return bestScore;
 }
 
+void ChessSearcher::prepareMoveOrdering(BoardType& board, Depth currentDepth)
+{
+    SearchStack& searchStack = this->searchStack[currentDepth];
+
+    searchStack.counterMove = MoveType();
+    searchStack.continuationHistory[0] = nullptr;
+    searchStack.continuationHistory[1] = nullptr;
+
+    //A null move, or the root, leaves movedPiece empty
+    if (currentDepth >= Depth::ONE) {
+        MoveType& previousMove = this->searchStack[currentDepth - Depth::ONE].currentMove;
+
+        if (previousMove.movedPiece != PieceType::NO_PIECE) {
+            if (enableCounterMoves) {
+                searchStack.counterMove = this->counterMoveTable.get(board.sideToMove, previousMove.movedPiece, previousMove.dst);
+            }
+
+            if (enableContinuationHistory) {
+                searchStack.continuationHistory[0] = &this->counterMoveHistory.get(board.sideToMove, previousMove.movedPiece, previousMove.dst);
+            }
+        }
+    }
+
+    if (enableContinuationHistory
+        && currentDepth >= Depth::TWO) {
+        MoveType& ourPreviousMove = this->searchStack[currentDepth - Depth::TWO].currentMove;
+
+        if (ourPreviousMove.movedPiece != PieceType::NO_PIECE) {
+            searchStack.continuationHistory[1] = &this->followUpHistory.get(board.sideToMove, ourPreviousMove.movedPiece, ourPreviousMove.dst);
+        }
+    }
+}
+
+void ChessSearcher::printEvaluationStatistics()
+{
+    this->evaluator.printStatistics();
+
+    std::cout << "Beta cutoffs: " << this->betaCutoffCount;
+
+    if (this->betaCutoffCount != ZeroNodes) {
+        std::cout << " (first move: " << std::fixed << std::setprecision(1) << (100.0 * this->firstMoveBetaCutoffCount / this->betaCutoffCount) << "%)";
+    }
+
+    std::cout << std::endl;
+}
+
 void ChessSearcher::resetHashtable()
 {
     this->hashtable.reset();
 }
 
+void ChessSearcher::resetStageMargins()
+{
+    this->evaluator.resetStageMargins();
+}
+
+void ChessSearcher::printSearchLine(Depth maxDepth, Score score, ChessPrincipalVariation& principalVariation)
+{
+    std::cout << int(maxDepth / Depth::ONE) << " " << std::fixed << std::setprecision(2);
+    if (IsMateScore(score)) {
+        if (score > (WIN_SCORE - Depth::MAX)) {
+            score = 10000 - (WIN_SCORE - score);
+        }
+        else if (score < (-WIN_SCORE + Depth::MAX)) {
+            score = -10000 + (WIN_SCORE + score);
+        }
+
+        std::cout << score / 100.0f;
+    }
+    else {
+        std::cout << int(score / (PAWN_SCORE / 100.0f));
+    }
+
+    std::time_t time = clock.getElapsedTime(this->nodeCount);
+    std::cout << " " << time / 10 << " " << (this->nodeCount) << " ";
+
+    principalVariation.print();
+
+    std::cout << std::endl;
+}
+
 Score ChessSearcher::rootSearchImplementation(BoardType& board, ChessPrincipalVariation& principalVariation, Depth maxDepth, Score alpha, Score beta)
+{
+    //1) Open an aspiration window around the previous iteration's score.  Shallow iterations and mate scores keep the
+    //  window we were given.
+    const Score lowestAlpha = alpha;
+    const Score highestBeta = beta;
+
+    Score delta = AspirationWindows[0].mg;
+
+    if (enableAspirationWindows
+        && delta > ZERO_SCORE
+        && maxDepth >= aspirationWindowMinimumDepth
+        && !IsMateScore(this->previousIterationScore)) {
+        alpha = std::max(this->previousIterationScore - delta, lowestAlpha);
+        beta = std::min(this->previousIterationScore + delta, highestBeta);
+    }
+
+    //2) Search, widening whichever side of the window failed until the score lands inside it
+    Score score;
+
+    while (true) {
+        score = this->rootSearch(board, principalVariation, maxDepth, alpha, beta);
+
+        if (this->abortedSearch) {
+            break;
+        }
+
+        if (score <= alpha && alpha > lowestAlpha) {
+            alpha = std::max(score - delta, lowestAlpha);
+        }
+        else if (score >= beta && beta < highestBeta) {
+            beta = std::min(score + delta, highestBeta);
+        }
+        else {
+            break;
+        }
+
+        delta += delta * AspirationWindows[1].mg / 100;
+    }
+
+    //3) Print the iteration's result.  An aborted iteration has no score of its own to show.
+    if (!this->abortedSearch) {
+        this->previousIterationScore = score;
+
+        this->printSearchLine(maxDepth, score, principalVariation);
+    }
+
+    return score;
+}
+
+Score ChessSearcher::rootSearch(BoardType& board, ChessPrincipalVariation& principalVariation, Depth maxDepth, Score alpha, Score beta)
 {
     Score bestScore = -WIN_SCORE;
     constexpr Depth currentDepth = Depth::ZERO;
 
+    const Score originalAlpha = alpha;
+
     Score score;
 
     NodeCount movesSearched = ZeroNodes;
@@ -330,13 +551,15 @@ Score ChessSearcher::rootSearchImplementation(BoardType& board, ChessPrincipalVa
         nextBoard.doMove(move);
         this->addMoveToHistory(nextBoard, move);
 
+        this->searchStack[currentDepth].currentMove = move;
+
         if (movesSearched == ZeroNodes) {
             score = -this->search<NodeType::PV_NODETYPE>(nextBoard, -beta, -alpha, maxDepth, Depth::ONE);
         }
         else {
             score = -this->search<NodeType::CUT_NODETYPE>(nextBoard, -(alpha + 1), -alpha, maxDepth, Depth::ONE);
 
-            if (score > alpha) {
+            if (score > alpha && score < beta) {
                 score = -this->search<NodeType::PV_NODETYPE>(nextBoard, -beta, -alpha, maxDepth, Depth::ONE);
             }
         }
@@ -351,72 +574,29 @@ Score ChessSearcher::rootSearchImplementation(BoardType& board, ChessPrincipalVa
 
         if (score > bestScore) {
             bestScore = score;
-
-            if (bestScore >= beta) {
-                break;
-            }
         }
 
-        if (score > alpha
-            || movesSearched == ZeroNodes) {
-            alpha = score;
-
-            std::cout << int(maxDepth / Depth::ONE) << " " << std::fixed << std::setprecision(2);
-            if (IsMateScore(score)) {
-                if (score > (WIN_SCORE - Depth::MAX)) {
-                    score = 10000 - (WIN_SCORE - score);
-                }
-                else if (score < (-WIN_SCORE + Depth::MAX)) {
-                    score = -10000 + (WIN_SCORE + score);
-                }
-
-                std::cout << score / 100.0f;
-            }
-            else {
-                std::cout << int(score / (PAWN_SCORE / 100.0f));
-            }
-
-            std::time_t time = clock.getElapsedTime(this->nodeCount);
-
-            std::cout << " " << time / 10 << " " << (this->nodeCount) << " ";
-
+        //A move that beats alpha becomes the PV even when it fails high, so an interrupted re-search still plays it.
+        //  The line is printed once per iteration by rootSearchImplementation.
+        if (score > alpha) {
             ChessPrincipalVariation& nextPrincipalVariation = this->searchStack[currentDepth + Depth::ONE].principalVariation;
 
             principalVariation.copyBackward(nextPrincipalVariation, move);
-            principalVariation.print();
 
-            std::cout << std::endl;
+            if (score >= beta) {
+                break;
+            }
+
+            alpha = score;
         }
 
         movesSearched++;
     }
 
-    MoveType move = principalVariation[0];
-    score = Score(move.ordinal);
-
-    std::cout << int(maxDepth / Depth::ONE) << " " << std::fixed << std::setprecision(2);
-    if (IsMateScore(score)) {
-        if (score > (WIN_SCORE - Depth::MAX)) {
-            score = 10000 - (WIN_SCORE - score);
-        }
-        else if (score < (-WIN_SCORE + Depth::MAX)) {
-            score = -10000 + (WIN_SCORE + score);
-        }
-
-        std::cout << score / 100.0f;
+    //After a fail low every score is only an upper bound, so keep the previous order for the re-search
+    if (bestScore > originalAlpha) {
+        std::stable_sort(this->rootMoveList.begin(), this->rootMoveList.begin() + this->rootMoveList.size(), greater<MoveType>);
     }
-    else {
-        std::cout << int(score / (PAWN_SCORE / 100.0f));
-    }
-
-    std::time_t time = clock.getElapsedTime(this->nodeCount);
-    std::cout << " " << time / 10 << " " << (this->nodeCount) << " ";
-
-    principalVariation.print();
-
-    std::cout << std::endl;
-
-    std::stable_sort(this->rootMoveList.begin(), this->rootMoveList.begin() + this->rootMoveList.size(), greater<MoveType>);
 
     return bestScore;
 }
@@ -450,6 +630,19 @@ Score ChessSearcher::search(BoardType& board, Score alpha, Score beta, Depth max
         return DRAW_SCORE;
     }
 
+    //Bitbase positions need no further search.  A draw is exact; a win is at least as good as its score and a loss at
+    //  least as bad, so those only end the search when they fall outside the window.
+    Score bitbaseScore;
+    if (board.pieceCount <= std::int32_t(WdlMaxPieces)
+        && ProbeBitbases(board, bitbaseScore)
+        && (bitbaseScore == DRAW_SCORE
+            || (bitbaseScore > DRAW_SCORE && bitbaseScore >= beta)
+            || (bitbaseScore < DRAW_SCORE && bitbaseScore <= alpha))) {
+        currentPrincipalVariation.clear();
+
+        return bitbaseScore;
+    }
+
     //3) Mate Distance Pruning
     if (enableMateDistancePruning) {
         alpha = std::max(-WIN_SCORE + currentDepth, alpha);
@@ -467,7 +660,7 @@ Score ChessSearcher::search(BoardType& board, Score alpha, Score beta, Depth max
     if (!isInCheck && (currentDepth >= maxDepth)) {
         currentPrincipalVariation.clear();
 
-        return this->quiescenceSearch<nodeType>(board, alpha, beta, currentDepth, maxDepth);
+        return this->quiescenceSearch<nodeType>(board, alpha, beta, currentDepth, currentDepth);
     }
 
     //5) Increment the Node Count
@@ -515,6 +708,8 @@ Score ChessSearcher::search(BoardType& board, Score alpha, Score beta, Depth max
         BoardType nextBoard = board;
         nextBoard.doNullMove();
 
+        searchStack.currentMove = MoveType();
+
         constexpr Depth nullReduction = Depth::THREE;
         Score nullScore = -this->search<NodeType::ALL_NODETYPE>(nextBoard, -beta, -beta + 1, maxDepth - nullReduction, currentDepth + Depth::ONE);
 
@@ -569,22 +764,105 @@ Score ChessSearcher::search(BoardType& board, Score alpha, Score beta, Depth max
         }
     }
 
-    //10) Begin Search Loop
+    bool hasHashMove = enableSearchHashtable
+        && DecodeHashMove(moveList, searchStack.hashMoveRank, searchStack.hashMove);
+
+    if (!hasHashMove) {
+        searchStack.hashMove = MoveType();
+    }
+
+    //10) ProbCut.  If a good capture still beats beta by a margin at reduced depth, a full depth search would almost
+    //  certainly fail high too.
+    if (enableProbCut
+        && !isMateThreat
+        && !isMateSearch
+        && nodeType != NodeType::PV_NODETYPE
+        && !isInCheck
+        && depthLeft >= ProbCut[0].mg
+        && !IsMateScore(beta)) {
+        Score probCutBeta = beta + ProbCut[2].mg;
+        Depth probCutMaxDepth = Depth(maxDepth - ProbCut[1].mg);
+
+        for (MoveList<MoveType>::iterator it = moveList.begin(); it != moveList.end(); ++it) {
+            MoveType& move = (*it);
+
+            if (board.pieces[move.dst] == PieceType::NO_PIECE
+                || !this->attackGenerator.seeGreaterOrEqual(board, move, probCutBeta - searchStack.staticEvaluation)) {
+                continue;
+            }
+
+            BoardType nextBoard = board;
+            nextBoard.doMove(move);
+            this->addMoveToHistory(nextBoard, move);
+
+            searchStack.currentMove = move;
+
+            Score probCutScore = -this->search<NodeType::ALL_NODETYPE>(nextBoard, -probCutBeta, -probCutBeta + 1, probCutMaxDepth, currentDepth + Depth::ONE);
+
+            this->removeLastMoveFromHistory();
+
+            if (this->abortedSearch) {
+                return NO_SCORE;
+            }
+
+            if (probCutScore >= probCutBeta) {
+                currentPrincipalVariation.clear();
+
+                return probCutScore;
+            }
+        }
+    }
+
+    //11) Singular Extensions.  The hash move's lower bound says it is good; search the other moves at half depth against
+    //  a margin below it.  If they all fail low, the hash move is the only good move and is extended a ply.  If one of
+    //  them still beats beta, more than one move refutes the previous move and the node fails high (multi-cut).
+    searchStack.hashMoveExtension = Depth::ZERO;
+
+    if (enableSingularExtensions
+        && hasHashMove
+        && depthLeft >= SingularExtensions[0].mg
+        && searchStack.hashEntryType == HASHENTRYTYPE_LOWER_BOUND
+        && searchStack.hashDepthLeft >= depthLeft - SingularExtensions[1].mg
+        && !IsMateScore(searchStack.hashScore)) {
+        Score singularBeta = searchStack.hashScore - SingularExtensions[2].mg * depthLeft;
+
+        searchStack.excludedMove = searchStack.hashMove;
+        Score singularScore = this->searchLoop<NodeType::CUT_NODETYPE>(board, singularBeta - 1, singularBeta, currentDepth + depthLeft / 2, currentDepth);
+        searchStack.excludedMove = MoveType();
+
+        if (this->abortedSearch) {
+            return NO_SCORE;
+        }
+
+        if (singularScore < singularBeta) {
+            searchStack.hashMoveExtension = Depth::ONE;
+        }
+        else if (nodeType != NodeType::PV_NODETYPE
+            && singularBeta >= beta) {
+            currentPrincipalVariation.clear();
+
+            return singularBeta;
+        }
+    }
+
+    //12) Begin Search Loop
     Score resultScore = this->searchLoop<nodeType>(board, alpha, beta, maxDepth, currentDepth);
 
-    //11) Store Result in Hashtable
+    //13) Store Result in Hashtable, with the move that failed high
     if (enableSearchHashtable) {
         HashtableEntryType hashtableEntryType = HASHENTRYTYPE_NONE;
+        std::uint8_t hashMoveRank = 0;
 
         if (resultScore >= beta) {
             hashtableEntryType = HASHENTRYTYPE_LOWER_BOUND;
+            hashMoveRank = EncodeHashMove(moveList, searchStack.bestMove);
         }
         else if (resultScore < alpha) {
             hashtableEntryType = HASHENTRYTYPE_UPPER_BOUND;
         }
 
         if (hashtableEntryType != HASHENTRYTYPE_NONE) {
-            this->hashtable.insert(board.hashValue, resultScore, currentDepth, depthLeft, hashtableEntryType, 0);
+            this->hashtable.insert(board.hashValue, resultScore, currentDepth, depthLeft, hashtableEntryType, hashMoveRank);
         }
     }
 
@@ -599,7 +877,10 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
 
     MoveList<MoveType>& moveList = searchStack.moveList;
 
-    //1) Internal Iterative Deepening
+    //1) Find the counter move and continuation histories for the previous moves
+    this->prepareMoveOrdering(board, currentDepth);
+
+    //2) Internal Iterative Deepening
     if (enableIID
         //&& nodeType != NodeType::PV_NODE
         && depthLeft > Depth::THREE) {
@@ -610,19 +891,20 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
     }
     else {
         //Sort Moves by expected value
-        this->moveGenerator.reorderMoves<nodeType>(board, moveList, searchStack, this->butterflyTable);
+        this->moveGenerator.reorderMoves<nodeType>(board, moveList, searchStack, this->butterflyTable, this->captureHistory);
+
+        std::stable_sort(moveList.begin(), moveList.end(), greater<MoveType>);
     }
 
     ChessPrincipalVariation& currentPrincipalVariation = searchStack.principalVariation;
     ChessPrincipalVariation& nextPrincipalVariation = this->searchStack[currentDepth + Depth::ONE].principalVariation;
 
-    //2) Calculate Position Extensions (independent of type of move)
+    //3) Calculate Position Extensions (independent of type of move)
     Depth positionExtensions = Depth::ZERO;
+    bool isInCheck = this->attackGenerator.isInCheck(board);
 
     if (enableSearchExtensions
         && currentDepth >= Depth::TWO) {
-        bool isInCheck = this->attackGenerator.isInCheck(board);
-
         //***Don't use this reference if currentDepth <= 1***
 //        SearchStack& ourLastSearchStack = this->searchStack[currentDepth - Depth::TWO];
 
@@ -637,14 +919,25 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
         //}
     }
 
-    //3) MoveList loop
+    //4) MoveList loop.  Pruned moves are left out of the searched lists, so they never get a history malus.  A singular
+    //  search only tests the other moves against a margin, so its cutoffs don't update the move ordering tables.  An empty
+    //  excluded move has src == dst.
+    bool isSingularSearch = searchStack.excludedMove.src != searchStack.excludedMove.dst;
+
     NodeCount searchedMoves = ZeroNodes;
-    NodeCount quietMoves = ZeroNodes;
     Score bestScore = -WIN_SCORE;
 
+    searchStack.searchedQuietMoves.clear();
+    searchStack.searchedCaptures.clear();
+
     for (MoveList<MoveType>::iterator it = moveList.begin(); it != moveList.end(); ++it) {
         MoveType& move = (*it);
 
+        //A singular extension search leaves out the hash move
+        if (searchStack.excludedMove == move) {
+            continue;
+        }
+
         Square src = move.src;
         Square dst = move.dst;
 
@@ -652,12 +945,70 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
         PieceType capturedPiece = board.pieces[dst];
         PieceType promotionPiece = move.promotionPiece;
 
-        //4) Calculate Reductions
+        bool givesCheck = this->attackGenerator.givesCheck(board, move);
+
+        //5) Prune late quiet moves, and quiet moves with a poor history, in shallow non-PV nodes once a move has been
+        //  searched.  Checks, killers and pawn pushes to the 7th rank are always searched.
+        Rank seventhRank = board.sideToMove == Color::WHITE ? Rank::_7 : Rank::_2;
+
+        if (nodeType != NodeType::PV_NODETYPE
+            && !isInCheck
+            && !givesCheck
+            && !IsMateScore(bestScore)
+            && capturedPiece == PieceType::NO_PIECE
+            && promotionPiece == PieceType::NO_PIECE
+            && searchStack.killer1 != move
+            && searchStack.killer2 != move
+            && !(movingPiece == PieceType::PAWN && getRank(dst) == seventhRank)) {
+            if (enableLateMovePruning
+                && depthLeft <= LateMovePruning[2].mg
+                && std::int32_t(searchStack.searchedQuietMoves.size()) >= LateMovePruning[0].mg + LateMovePruning[1].mg * depthLeft * depthLeft) {
+                continue;
+            }
+
+            if (enableHistoryPruning
+                && depthLeft <= HistoryPruning[0].mg) {
+                std::int32_t historyScore = 0;
+
+                for (PieceSquareHistory* continuationHistory : searchStack.continuationHistory) {
+                    if (continuationHistory != nullptr) {
+                        historyScore += (*continuationHistory)[movingPiece][dst];
+                    }
+                }
+
+                if (historyScore < -HistoryPruning[1].mg * depthLeft) {
+                    continue;
+                }
+            }
+        }
+
+        //6) Prune moves that lose material by SEE in shallow non-PV nodes once a move has been searched.  Checks and
+        //  promotions are always searched.
+        if (enableSeePruning
+            && nodeType != NodeType::PV_NODETYPE
+            && !isInCheck
+            && !givesCheck
+            && !IsMateScore(bestScore)
+            && promotionPiece == PieceType::NO_PIECE
+            && depthLeft <= SeePruning[0].mg) {
+            Score seeMargin = capturedPiece == PieceType::NO_PIECE ? SeePruning[1].mg : SeePruning[2].mg;
+
+            if (!this->attackGenerator.seeGreaterOrEqual(board, move, -seeMargin * depthLeft)) {
+                continue;
+            }
+        }
+
+        //7) Calculate Reductions.  Checking moves are never reduced.
         Depth extensions = positionExtensions;
 
+        if (searchStack.hashMove == move) {
+            extensions += searchStack.hashMoveExtension;
+        }
+
         if (enableSearchReductions
             && nodeType != NodeType::PV_NODETYPE
             && extensions == Depth::ZERO
+            && !givesCheck
             && searchedMoves > ZeroNodes) {
             float l1 = (1.0f + LateMoveReductions[0].mg / 100.0f) * std::log(float(currentDepth + Depth::ONE));
             float l2 = (1.0f + LateMoveReductions[1].mg / 100.0f) * std::log(float(depthLeft + Depth::ONE));
@@ -668,17 +1019,19 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
             extensions -= Depth::ONE * reduction;
 
             constexpr Score staticExchangeEvaluationReductionThreshold = Score(1 * PAWN_SCORE);
-            if (this->staticExchangeEvaluation(board, src, dst) < staticExchangeEvaluationReductionThreshold) {
+            if (!this->attackGenerator.seeGreaterOrEqual(board, move, staticExchangeEvaluationReductionThreshold)) {
                 extensions -= Depth::ONE;
             }
         }
 
-        //5) DoMove
+        //8) DoMove
         BoardType nextBoard = board;
         nextBoard.doMove(move);
         this->addMoveToHistory(nextBoard, move);
 
-        //6) Recurse to next depth
+        searchStack.currentMove = move;
+
+        //9) Recurse to next depth
         Score nextScore;
 
         switch (nodeType) {
@@ -712,10 +1065,10 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
             break;
         }
 
-        //7) Undo Move
+        //10) Undo Move
         this->removeLastMoveFromHistory();
 
-        //8) Compare returned value to alpha/beta
+        //11) Compare returned value to alpha/beta
         move.ordinal = ChessMoveOrdinal(nextScore);
 
         if (nextScore > bestScore) {
@@ -726,14 +1079,19 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
 
         if (nextScore > alpha) {
             if (nextScore >= beta) {
-                if (enableButterflyTable) {
-                    this->butterflyTable.add(movingPiece, dst, 1);
-                }
+                if (!isSingularSearch) {
+                    if ((capturedPiece == PieceType::NO_PIECE) && (promotionPiece == PieceType::NO_PIECE)) {
+                        if (searchStack.killer1 != move) {
+                            searchStack.killer2 = searchStack.killer1;
+                            searchStack.killer1 = move;
+                        }
+                    }
 
-                if ((capturedPiece == PieceType::NO_PIECE) && (promotionPiece == PieceType::NO_PIECE)) {
-                    if (searchStack.killer1 != move) {
-                        searchStack.killer2 = searchStack.killer1;
-                        searchStack.killer1 = move;
+                    this->updateMoveHistory(board, depthLeft, currentDepth, move);
+
+                    this->betaCutoffCount++;
+                    if (searchedMoves == ZeroNodes) {
+                        this->firstMoveBetaCutoffCount++;
                     }
                 }
 
@@ -749,8 +1107,11 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
             searchStack.pvMove = move;
         }
 
-        if ((capturedPiece == PieceType::NO_PIECE) && (promotionPiece == PieceType::NO_PIECE)) {
-            quietMoves++;
+        if (capturedPiece != PieceType::NO_PIECE) {
+            searchStack.searchedCaptures.push_back(move);
+        }
+        else if (promotionPiece == PieceType::NO_PIECE) {
+            searchStack.searchedQuietMoves.push_back(move);
         }
 
         searchedMoves++;
@@ -759,124 +1120,59 @@ Score ChessSearcher::searchLoop(BoardType& board, Score alpha, Score beta, Depth
     return bestScore;
 }
 
-#define SeeMaterialValue(x) (MaterialParameters[x].mg)
-
-Score ChessSearcher::staticExchangeEvaluation(BoardType& board, Square src, Square dst)
+void ChessSearcher::updateMoveHistory(BoardType& board, Depth depthLeft, Depth currentDepth, MoveType& cutoffMove)
 {
-    PieceType movingPiece = board.pieces[src];
-    PieceType capturedPiece = board.pieces[dst];
-
-    bool whiteToMove = board.sideToMove == Color::WHITE;
-
-    Bitboard* piecesToMove = whiteToMove ? board.whitePieces : board.blackPieces;
-    Bitboard* otherPieces = whiteToMove ? board.blackPieces : board.whitePieces;
-
-    Score gain[32];
-
-    PieceType bestKnown[Color::COLOR_COUNT] = { PieceType::PAWN, PieceType::PAWN };
-
-    //1) If the captured piece value > the moving piece value, return a quick SEE score
-    if (SeeMaterialValue(capturedPiece) > SeeMaterialValue(movingPiece)) {
-        return SeeMaterialValue(capturedPiece) - SeeMaterialValue(movingPiece);
-    }
-
-    //2) Get all of the valid pieces on the board that can be used for SEE
-    Bitboard validAttackers = WhitePawnCaptures[dst] & board.blackPieces[PieceType::PAWN]
-        | BlackPawnCaptures[dst] & board.whitePieces[PieceType::PAWN];
-
-    for (PieceType piece = PieceType::KNIGHT; piece <= PieceType::KING; piece++) {
-        validAttackers |= PieceMoves[piece][dst] & (board.whitePieces[piece] | board.blackPieces[piece]);
-    }
-
-    if ((validAttackers & board.allPieces) == EmptyBitboard) {
-        return ZERO_SCORE;
-    }
+    SearchStack& searchStack = this->searchStack[currentDepth];
 
-    //3) Exclude the original captured piece and the first attacker on the source square
-    validAttackers ^= OneShiftedBy(src) ^ OneShiftedBy(dst);
+    PieceType cutoffPiece = board.pieces[cutoffMove.src];
+    PieceType cutoffVictim = board.pieces[cutoffMove.dst];
 
-    //4) Set Side To Move Attackers
-    whiteToMove = !whiteToMove;
-    std::swap(piecesToMove, otherPieces);
+    bool isQuietCutoff = cutoffVictim == PieceType::NO_PIECE
+        && cutoffMove.promotionPiece == PieceType::NO_PIECE;
 
-    Bitboard sideToMoveAttackers = validAttackers & piecesToMove[PieceType::ALL];
+    //1) A quiet cutoff move refutes the previous move
+    if (enableCounterMoves
+        && isQuietCutoff
+        && currentDepth >= Depth::ONE) {
+        MoveType& previousMove = this->searchStack[currentDepth - Depth::ONE].currentMove;
 
-    //5) If the other side has no pieces to recapture, return the value of the captured piece
-        //without capturing the moved piece
-    if (sideToMoveAttackers == EmptyBitboard) {
-        return SeeMaterialValue(capturedPiece);
+        if (previousMove.movedPiece != PieceType::NO_PIECE) {
+            this->counterMoveTable.get(board.sideToMove, previousMove.movedPiece, previousMove.dst) = cutoffMove;
+        }
     }
 
-    //6) Begin the loop
-    gain[0] = SeeMaterialValue(capturedPiece);
-    std::int32_t depth = 1;
-
-    capturedPiece = movingPiece;
-
-    Bitboard attackingPieces;
-
-    bool found = false;
-    do {
-        found = false;
+    //2) Reward the cutoff move and penalize the moves searched before it.  Captures are always penalized, but quiet moves
+    //  are only compared against a quiet cutoff.
+    std::int32_t bonus = GetHistoryBonus(depthLeft);
 
-        //7) Get the least valuable attacker for the side to move
-        PieceType currentPiece = bestKnown[whiteToMove];
-
-        while (!found && currentPiece <= PieceType::KING) {
-            attackingPieces = piecesToMove[currentPiece];
-
-            if ((sideToMoveAttackers & attackingPieces) != EmptyBitboard) {
-                found = true;
-            }
-            else {
-                currentPiece++;
-            }
+    if (enableCaptureHistory) {
+        if (cutoffVictim != PieceType::NO_PIECE) {
+            UpdateHistory(this->captureHistory.get(cutoffPiece, cutoffMove.dst, cutoffVictim), bonus);
         }
 
-        if (!found) {
-            break;
+        for (MoveType& move : searchStack.searchedCaptures) {
+            UpdateHistory(this->captureHistory.get(board.pieces[move.src], move.dst, board.pieces[move.dst]), -bonus);
         }
+    }
 
-        //7b) Save the least valueable attacker for the side to move
-        bestKnown[whiteToMove] = currentPiece;
-
-        //8) Remove the attacker from the attackers bitboard
-        Bitboard b = sideToMoveAttackers & attackingPieces;
-        Square attackSrc;
-
-        BitScanForward64((std::uint32_t *)&attackSrc, b);
-        validAttackers = ResetLowestSetBit(validAttackers);
+    if (enableButterflyTable
+        && isQuietCutoff) {
+        UpdateHistory(this->butterflyTable.get(board.sideToMove, cutoffPiece, cutoffMove.dst), bonus);
 
-        //9) If there are no pieces in between the attacker and the destination square, allow
-        //  the piece to participate in the SEE
-        if ((InBetween[attackSrc][dst] & board.allPieces) == EmptyBitboard) {
-            gain[depth] = SeeMaterialValue(capturedPiece) - gain[depth - 1];
+        for (MoveType& move : searchStack.searchedQuietMoves) {
+            UpdateHistory(this->butterflyTable.get(board.sideToMove, board.pieces[move.src], move.dst), -bonus);
+        }
+    }
 
-            if (capturedPiece == PieceType::KING) {
-                break;
-            }
+    if (isQuietCutoff) {
+        for (PieceSquareHistory* continuationHistory : searchStack.continuationHistory) {
+            if (continuationHistory != nullptr) {
+                UpdateHistory((*continuationHistory)[cutoffPiece][cutoffMove.dst], bonus);
 
-            //10) Early pruning of SEE score
-            if (-gain[depth - 1] < 0
-                && gain[depth] < 0) {
-                break;
+                for (MoveType& move : searchStack.searchedQuietMoves) {
+                    UpdateHistory((*continuationHistory)[board.pieces[move.src]][move.dst], -bonus);
+                }
             }
-
-            depth++;
-
-            capturedPiece = currentPiece;
-
-            whiteToMove = !whiteToMove;
-            std::swap(piecesToMove, otherPieces);
         }
-
-        sideToMoveAttackers = validAttackers & piecesToMove[PieceType::ALL];
-    } while ((sideToMoveAttackers != EmptyBitboard) || !found);
-
-    //11) Finish calculating the SEE
-    while (depth--) {
-        gain[depth - 1] = std::min(-gain[depth], gain[depth - 1]);
     }
-
-    return gain[0];
 }
@@ -26,6 +26,8 @@
 #include "../eval/evaluator.h"
 
 #include "butterfly.h"
+#include "capturehistory.h"
+#include "continuation.h"
 #include "movehistory.h"
 #include "chesspv.h"
 
@@ -39,22 +41,37 @@ class ChessSearcher : public Searcher<ChessSearcher, ChessEvaluator, ChessMoveGe
 protected:
     ChessAttackGenerator attackGenerator;
     ChessButterflyTable butterflyTable;
+    ChessCaptureHistory captureHistory;
+    ChessContinuationHistory counterMoveHistory, followUpHistory;
+    ChessCounterMoveTable counterMoveTable;
     Hashtable hashtable;
 
     MoveList<MoveType> rootMoveList;
     SearchStack searchStack[SearchStackSize];
 
+    Score previousIterationScore;
+
+    NodeCount betaCutoffCount, firstMoveBetaCutoffCount;
+
     template <NodeType nodeType>
     HashtableEntryType checkHashtable(BoardType& board, Score& hashScore, Depth depthLeft, Depth currentDepth);
 
+    void prepareMoveOrdering(BoardType& board, Depth currentDepth);
+
+    void printSearchLine(Depth maxDepth, Score score, ChessPrincipalVariation& principalVariation);
+
     template <NodeType nodeType>
     Score quiescenceSearch(BoardType& board, Score alpha, Score beta, Depth currentDepth, Depth maxDepth);
 
+    Score rootSearch(BoardType& board, ChessPrincipalVariation& principalVariation, Depth maxDepth, Score alpha, Score beta);
+
     template <NodeType nodeType>
     Score search(BoardType& board, Score alpha, Score beta, Depth maxDepth, Depth currentDepth);
 
     template <NodeType nodeType>
     Score searchLoop(BoardType& board, Score alpha, Score beta, Depth maxDepth, Depth currentDepth);
+
+    void updateMoveHistory(BoardType& board, Depth depthLeft, Depth currentDepth, MoveType& cutoffMove);
 public:
     ChessSearcher();
     ~ChessSearcher();
@@ -63,9 +80,10 @@ public:
 
     void initializeSearchImplementation(BoardType& board);
 
+    void printEvaluationStatistics();
+
     void resetHashtable();
+    void resetStageMargins();
 
     Score rootSearchImplementation(BoardType& board, ChessPrincipalVariation& pv, Depth maxDepth, Score alpha, Score beta);
-
-    Score staticExchangeEvaluation(BoardType& board, Square src, Square dst);
 };
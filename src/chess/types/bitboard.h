@@ -31,3 +31,22 @@ static constexpr Bitboard LightSquares = Bitboard(0x5555555555555555);
 
 #define SameColorAsPiece(x,b) ( IsDarkSquare(b) ? DarkSquarePieces(x) : LightSquarePieces(x) )
 #define OppositeColorAsPiece(x,b) ( IsDarkSquare(b) ? LightSquarePieces(x) : DarkSquarePieces(x) )
+
+//Smear every set bit toward the 8th rank (up) or the 1st rank (down), keeping the bit itself
+static constexpr Bitboard FillUp(Bitboard b)
+{
+    b |= b >> 8;
+    b |= b >> 16;
+    b |= b >> 32;
+
+    return b;
+}
+
+static constexpr Bitboard FillDown(Bitboard b)
+{
+    b |= b << 8;
+    b |= b << 16;
+    b |= b << 32;
+
+    return b;
+}
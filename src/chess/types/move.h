@@ -27,14 +27,15 @@ enum ChessMoveOrdinal {
     NO_CHESS_MOVE_ORDINAL,
     PV_MOVE = -1000000,
     QUIESENCE_MOVE = -1000000,
+    HASH_MOVE = -1500000,
     GOOD_CAPTURE_MOVE = -2000000,
-    EQUAL_CAPTURE_MOVE = -3000000,
     KILLER1_MOVE = -4000000,
     KILLER2_MOVE = -5000000,
+    COUNTER_MOVE = -5500000,
     BUTTERFLY_MOVE = -6000000,
     UNCLASSIFIED_MOVE = -6000000,
-    BAD_CAPTURE_MOVE = -7000000,
-    UNSAFE_MOVE = -8000000
+    UNSAFE_MOVE = -7000000,
+    BAD_CAPTURE_MOVE = -8000000
 };
 
 static ChessMoveOrdinal operator + (ChessMoveOrdinal cmo1, ChessMoveOrdinal cmo2)
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "../../game/types/score.h"
 
 static constexpr Score PAWN_SCORE = 128;
@@ -25,3 +27,80 @@ static constexpr Score KNIGHT_SCORE = 416;
 static constexpr Score BISHOP_SCORE = 416;
 static constexpr Score ROOK_SCORE = 736;
 static constexpr Score QUEEN_SCORE = 1344;
+
+//A packed evaluation keeps the middle game score in the high 16 bits and the end game score in the low 16 bits of a single
+//	integer.  Adding, subtracting and multiplying by a constant then work on both halves at once.  Intermediate results
+//	may carry from one half into the other, as long as the final halves fit in 16 bits.
+typedef std::int32_t PackedEvaluation;
+
+static constexpr PackedEvaluation PackEvaluation(Score mg, Score eg)
+{
+    return PackedEvaluation(std::uint32_t(mg) << 16) + eg;
+}
+
+static constexpr Score UnpackMg(PackedEvaluation evaluation)
+{
+    return Score(std::int16_t(std::uint16_t((std::uint32_t(evaluation) + 0x8000) >> 16)));
+}
+
+static constexpr Score UnpackEg(PackedEvaluation evaluation)
+{
+    return Score(std::int16_t(std::uint16_t(std::uint32_t(evaluation))));
+}
+
+//ChessEvaluation is what the board and evaluators accumulate into.  USE_PACKED_EVALUATION selects the packed form.
+#ifdef USE_PACKED_EVALUATION
+typedef PackedEvaluation ChessEvaluation;
+
+static const ChessEvaluation ZeroChessEvaluation = 0;
+
+static ChessEvaluation ToChessEvaluation(Evaluation evaluation)
+{
+    return PackEvaluation(evaluation.mg, evaluation.eg);
+}
+
+static constexpr ChessEvaluation MakeChessEvaluation(Score mg, Score eg)
+{
+    return PackEvaluation(mg, eg);
+}
+
+static Score GetMg(ChessEvaluation evaluation)
+{
+    return UnpackMg(evaluation);
+}
+
+static Score GetEg(ChessEvaluation evaluation)
+{
+    return UnpackEg(evaluation);
+}
+#else
+typedef Evaluation ChessEvaluation;
+
+static const ChessEvaluation ZeroChessEvaluation = { ZERO_SCORE, ZERO_SCORE };
+
+static ChessEvaluation ToChessEvaluation(Evaluation evaluation)
+{
+    return evaluation;
+}
+
+static constexpr ChessEvaluation MakeChessEvaluation(Score mg, Score eg)
+{
+    return { mg, eg };
+}
+
+static Score GetMg(ChessEvaluation evaluation)
+{
+    return evaluation.mg;
+}
+
+static Score GetEg(ChessEvaluation evaluation)
+{
+    return evaluation.eg;
+}
+#endif
+
+//Blend the middle game and end game scores by the number of pieces left on the board
+static Score TaperEvaluation(ChessEvaluation evaluation, std::int32_t pieceCount)
+{
+    return ((GetMg(evaluation) * pieceCount) + (GetEg(evaluation) * (32 - pieceCount))) / 32;
+}
@@ -18,10 +18,16 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "move.h"
 
 #include "../search/chesspv.h"
+#include "../search/continuation.h"
+
+#include "../../game/search/hashtable.h"
 
+#include "../../game/types/depth.h"
 #include "../../game/types/movelist.h"
 #include "../../game/types/score.h"
 
@@ -29,7 +35,16 @@ struct SearchStack {
     ChessMove pvMove;
     ChessMove bestMove, hashMove;
     ChessMove killer1, killer2;
+    ChessMove currentMove, counterMove, excludedMove;
+    PieceSquareHistory* continuationHistory[2];     //Following the moves one and two plies back, or nullptr
     MoveList<ChessMove> moveList;
+    MoveList<ChessMove> searchedQuietMoves, searchedCaptures;   //Moves actually searched so far at this node
     ChessPrincipalVariation principalVariation;
     Score staticEvaluation;
+
+    //What the hashtable held for this node, even if it was too shallow to use, and the extension it earned the hash move
+    HashtableEntryType hashEntryType;
+    Score hashScore;
+    Depth hashDepthLeft, hashMoveExtension;
+    std::uint8_t hashMoveRank;
 };